@@ -40,6 +40,7 @@ RCPP_MODULE(eGARCH) {
       .method("f_cdf", &eGARCH_norm::f_cdf)
       .method("f_cdf_its", &eGARCH_norm::f_cdf_its)
       .method("f_simAhead", &eGARCH_norm::f_simAhead)
+      .method("f_simAhead_filter", &eGARCH_norm::f_simAhead_filter)
       .method("f_get_sd", &eGARCH_norm::get_sd)
       .method("f_set_sd", &eGARCH_norm::set_sd)
       .method("f_get_mean", &eGARCH_norm::get_mean)
@@ -47,6 +48,17 @@ RCPP_MODULE(eGARCH) {
       .method("f_rnd", &eGARCH_norm::f_rnd)
       .method("calc_ht", &eGARCH_norm::calc_ht)
       .method("eval_model", &eGARCH_norm::eval_model)
+      .method("eval_model_grad", &eGARCH_norm::eval_model_grad)
+      .method("eval_model_score", &eGARCH_norm::eval_model_score)
+      .method("f_mcmc", &eGARCH_norm::f_mcmc)
+      .method("f_mcmc_chains", &eGARCH_norm::f_mcmc_chains)
+      .method("f_filter_init", &eGARCH_norm::f_filter_init)
+      .method("f_filter_update", &eGARCH_norm::f_filter_update)
+      .method("f_forecast_var", &eGARCH_norm::f_forecast_var)
+      .method("f_forecast_var_filter", &eGARCH_norm::f_forecast_var_filter)
+      .method("f_pred_filter", &eGARCH_norm::f_pred_filter)
+      .method("f_risk", &eGARCH_norm::f_risk)
+      .method("f_risk_filter", &eGARCH_norm::f_risk_filter)
       .method("ineq_func", &eGARCH_norm::ineq_func)
       .method("f_unc_vol", &eGARCH_norm::f_unc_vol);
   // eGARCH-std-symmetric
@@ -68,6 +80,7 @@ RCPP_MODULE(eGARCH) {
       .method("f_cdf", &eGARCH_std::f_cdf)
       .method("f_cdf_its", &eGARCH_std::f_cdf_its)
       .method("f_simAhead", &eGARCH_std::f_simAhead)
+      .method("f_simAhead_filter", &eGARCH_std::f_simAhead_filter)
       .method("f_get_sd", &eGARCH_std::get_sd)
       .method("f_set_sd", &eGARCH_std::set_sd)
       .method("f_get_mean", &eGARCH_std::get_mean)
@@ -75,6 +88,17 @@ RCPP_MODULE(eGARCH) {
       .method("f_rnd", &eGARCH_std::f_rnd)
       .method("calc_ht", &eGARCH_std::calc_ht)
       .method("eval_model", &eGARCH_std::eval_model)
+      .method("eval_model_grad", &eGARCH_std::eval_model_grad)
+      .method("eval_model_score", &eGARCH_std::eval_model_score)
+      .method("f_mcmc", &eGARCH_std::f_mcmc)
+      .method("f_mcmc_chains", &eGARCH_std::f_mcmc_chains)
+      .method("f_filter_init", &eGARCH_std::f_filter_init)
+      .method("f_filter_update", &eGARCH_std::f_filter_update)
+      .method("f_forecast_var", &eGARCH_std::f_forecast_var)
+      .method("f_forecast_var_filter", &eGARCH_std::f_forecast_var_filter)
+      .method("f_pred_filter", &eGARCH_std::f_pred_filter)
+      .method("f_risk", &eGARCH_std::f_risk)
+      .method("f_risk_filter", &eGARCH_std::f_risk_filter)
       .method("ineq_func", &eGARCH_std::ineq_func)
       .method("f_unc_vol", &eGARCH_std::f_unc_vol);
   // eGARCH-ged-symmetric
@@ -96,6 +120,7 @@ RCPP_MODULE(eGARCH) {
       .method("f_cdf", &eGARCH_ged::f_cdf)
       .method("f_cdf_its", &eGARCH_ged::f_cdf_its)
       .method("f_simAhead", &eGARCH_ged::f_simAhead)
+      .method("f_simAhead_filter", &eGARCH_ged::f_simAhead_filter)
       .method("f_get_sd", &eGARCH_ged::get_sd)
       .method("f_set_sd", &eGARCH_ged::set_sd)
       .method("f_get_mean", &eGARCH_ged::get_mean)
@@ -103,6 +128,17 @@ RCPP_MODULE(eGARCH) {
       .method("f_rnd", &eGARCH_ged::f_rnd)
       .method("calc_ht", &eGARCH_ged::calc_ht)
       .method("eval_model", &eGARCH_ged::eval_model)
+      .method("eval_model_grad", &eGARCH_ged::eval_model_grad)
+      .method("eval_model_score", &eGARCH_ged::eval_model_score)
+      .method("f_mcmc", &eGARCH_ged::f_mcmc)
+      .method("f_mcmc_chains", &eGARCH_ged::f_mcmc_chains)
+      .method("f_filter_init", &eGARCH_ged::f_filter_init)
+      .method("f_filter_update", &eGARCH_ged::f_filter_update)
+      .method("f_forecast_var", &eGARCH_ged::f_forecast_var)
+      .method("f_forecast_var_filter", &eGARCH_ged::f_forecast_var_filter)
+      .method("f_pred_filter", &eGARCH_ged::f_pred_filter)
+      .method("f_risk", &eGARCH_ged::f_risk)
+      .method("f_risk_filter", &eGARCH_ged::f_risk_filter)
       .method("ineq_func", &eGARCH_ged::ineq_func)
       .method("f_unc_vol", &eGARCH_ged::f_unc_vol);
 
@@ -125,6 +161,7 @@ RCPP_MODULE(eGARCH) {
       .method("f_cdf", &eGARCH_snorm::f_cdf)
       .method("f_cdf_its", &eGARCH_snorm::f_cdf_its)
       .method("f_simAhead", &eGARCH_snorm::f_simAhead)
+      .method("f_simAhead_filter", &eGARCH_snorm::f_simAhead_filter)
       .method("f_get_sd", &eGARCH_snorm::get_sd)
       .method("f_set_sd", &eGARCH_snorm::set_sd)
       .method("f_get_mean", &eGARCH_snorm::get_mean)
@@ -132,6 +169,17 @@ RCPP_MODULE(eGARCH) {
       .method("f_rnd", &eGARCH_snorm::f_rnd)
       .method("calc_ht", &eGARCH_snorm::calc_ht)
       .method("eval_model", &eGARCH_snorm::eval_model)
+      .method("eval_model_grad", &eGARCH_snorm::eval_model_grad)
+      .method("eval_model_score", &eGARCH_snorm::eval_model_score)
+      .method("f_mcmc", &eGARCH_snorm::f_mcmc)
+      .method("f_mcmc_chains", &eGARCH_snorm::f_mcmc_chains)
+      .method("f_filter_init", &eGARCH_snorm::f_filter_init)
+      .method("f_filter_update", &eGARCH_snorm::f_filter_update)
+      .method("f_forecast_var", &eGARCH_snorm::f_forecast_var)
+      .method("f_forecast_var_filter", &eGARCH_snorm::f_forecast_var_filter)
+      .method("f_pred_filter", &eGARCH_snorm::f_pred_filter)
+      .method("f_risk", &eGARCH_snorm::f_risk)
+      .method("f_risk_filter", &eGARCH_snorm::f_risk_filter)
       .method("ineq_func", &eGARCH_snorm::ineq_func)
       .method("f_unc_vol", &eGARCH_snorm::f_unc_vol);
   // eGARCH-std-skew
@@ -153,6 +201,7 @@ RCPP_MODULE(eGARCH) {
       .method("f_cdf", &eGARCH_sstd::f_cdf)
       .method("f_cdf_its", &eGARCH_sstd::f_cdf_its)
       .method("f_simAhead", &eGARCH_sstd::f_simAhead)
+      .method("f_simAhead_filter", &eGARCH_sstd::f_simAhead_filter)
       .method("f_get_sd", &eGARCH_sstd::get_sd)
       .method("f_set_sd", &eGARCH_sstd::set_sd)
       .method("f_get_mean", &eGARCH_sstd::get_mean)
@@ -160,6 +209,17 @@ RCPP_MODULE(eGARCH) {
       .method("f_rnd", &eGARCH_sstd::f_rnd)
       .method("calc_ht", &eGARCH_sstd::calc_ht)
       .method("eval_model", &eGARCH_sstd::eval_model)
+      .method("eval_model_grad", &eGARCH_sstd::eval_model_grad)
+      .method("eval_model_score", &eGARCH_sstd::eval_model_score)
+      .method("f_mcmc", &eGARCH_sstd::f_mcmc)
+      .method("f_mcmc_chains", &eGARCH_sstd::f_mcmc_chains)
+      .method("f_filter_init", &eGARCH_sstd::f_filter_init)
+      .method("f_filter_update", &eGARCH_sstd::f_filter_update)
+      .method("f_forecast_var", &eGARCH_sstd::f_forecast_var)
+      .method("f_forecast_var_filter", &eGARCH_sstd::f_forecast_var_filter)
+      .method("f_pred_filter", &eGARCH_sstd::f_pred_filter)
+      .method("f_risk", &eGARCH_sstd::f_risk)
+      .method("f_risk_filter", &eGARCH_sstd::f_risk_filter)
       .method("ineq_func", &eGARCH_sstd::ineq_func)
       .method("f_unc_vol", &eGARCH_sstd::f_unc_vol);
   // eGARCH-ged-skew
@@ -181,6 +241,7 @@ RCPP_MODULE(eGARCH) {
       .method("f_cdf", &eGARCH_sged::f_cdf)
       .method("f_cdf_its", &eGARCH_sged::f_cdf_its)
       .method("f_simAhead", &eGARCH_sged::f_simAhead)
+      .method("f_simAhead_filter", &eGARCH_sged::f_simAhead_filter)
       .method("f_get_sd", &eGARCH_sged::get_sd)
       .method("f_set_sd", &eGARCH_sged::set_sd)
       .method("f_get_mean", &eGARCH_sged::get_mean)
@@ -188,6 +249,17 @@ RCPP_MODULE(eGARCH) {
       .method("f_rnd", &eGARCH_sged::f_rnd)
       .method("calc_ht", &eGARCH_sged::calc_ht)
       .method("eval_model", &eGARCH_sged::eval_model)
+      .method("eval_model_grad", &eGARCH_sged::eval_model_grad)
+      .method("eval_model_score", &eGARCH_sged::eval_model_score)
+      .method("f_mcmc", &eGARCH_sged::f_mcmc)
+      .method("f_mcmc_chains", &eGARCH_sged::f_mcmc_chains)
+      .method("f_filter_init", &eGARCH_sged::f_filter_init)
+      .method("f_filter_update", &eGARCH_sged::f_filter_update)
+      .method("f_forecast_var", &eGARCH_sged::f_forecast_var)
+      .method("f_forecast_var_filter", &eGARCH_sged::f_forecast_var_filter)
+      .method("f_pred_filter", &eGARCH_sged::f_pred_filter)
+      .method("f_risk", &eGARCH_sged::f_risk)
+      .method("f_risk_filter", &eGARCH_sged::f_risk_filter)
       .method("ineq_func", &eGARCH_sged::ineq_func)
       .method("f_unc_vol", &eGARCH_sged::f_unc_vol);
 }
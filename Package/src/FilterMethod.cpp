@@ -0,0 +1,13 @@
+#include <RcppArmadillo.h>
+#include "Utils.h"
+
+using namespace Rcpp;
+
+// sets the algorithm of the Hamilton filter (see 'filter_method') and
+// returns the previous one
+// [[Rcpp::export]]
+int set_filter_method(const int& method) {
+  int old = filter_method();
+  filter_method() = method;
+  return old;
+}
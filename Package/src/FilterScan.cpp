@@ -0,0 +1,13 @@
+#include <RcppArmadillo.h>
+#include "Utils.h"
+
+using namespace Rcpp;
+
+// sets the evaluation of the likelihood (see 'filter_scan') and returns the
+// previous one
+// [[Rcpp::export]]
+int set_filter_scan(const int& scan) {
+  int old = filter_scan();
+  filter_scan() = scan;
+  return old;
+}
@@ -12,6 +12,8 @@ class Ged {
   double lncst;   // constant term in "kernel"
   double cst;     // constant term in "PDF"
   double lambda;  // lambda
+  double lnlambda;  // log(lambda)
+  std::shared_ptr<const QuantileTable> table;  // quantiles for "nu"
  public:
   double M1;  // E[|z|]
 
@@ -51,7 +53,10 @@ class Ged {
   }
 
   // set constant term of "kernel"
-  void prep_kernel() { lncst = log(cst); }
+  void prep_kernel() {
+    lncst = log(cst);
+    lnlambda = log(lambda);
+  }
 
   // returns loglikelihood of a single observation (must call "prep_kernel"
   // first)
@@ -60,6 +65,33 @@ class Ged {
            0.5 * pow(fabs(yi / (sqrt(vol.h) * lambda)), nu);
   }
 
+  // same as "kernel" for the "n" observations "y" with variances "h" (and
+  // their logarithms "lnh"), in "out" ("n" at most KERNEL_BLOCK_SIZE); the
+  // power is taken as 'exp(nu * log(|y| / (sqrt(h) * lambda)))'
+  void kernel_block(const double* h, const double* lnh, const double* y,
+                    double* out, const int& n) {
+    double tmp[KERNEL_BLOCK_SIZE];
+#pragma omp simd
+    for (int i = 0; i < n; i++) tmp[i] = fabs(y[i]);
+    vec_log(tmp, out, n);
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+      tmp[i] = nu * (out[i] - 0.5 * lnh[i] - lnlambda);
+    vec_exp(tmp, out, n);
+#pragma omp simd
+    for (int i = 0; i < n; i++) out[i] = lncst - 0.5 * lnh[i] - 0.5 * out[i];
+  }
+
+  // derivatives of "kernel" with respect to the variance and the observation
+  double kernel_dh(const volatility& vol, const double& yi) {
+    double u = fabs(yi / (sqrt(vol.h) * lambda));
+    return (0.25 * nu * pow(u, nu) - 0.5) / vol.h;
+  }
+  double kernel_dy(const volatility& vol, const double& yi) {
+    double s = sqrt(vol.h) * lambda;
+    return -0.5 * nu * pow(fabs(yi / s), nu - 1) * signum(yi) / s;
+  }
+
   // returns PDF evaluated at "x"
   double pdf(const double& x) {
     prep_kernel();
@@ -84,9 +116,25 @@ class Ged {
   double invsample(const double& u) {
     return (
         (u < 0.5)
-            ? -lambda * pow(2 * R::qgamma(1 - 2 * u, 1 / nu, 1, 1, 0), 1 / nu)
+            ? -lambda * pow(2 * R::qgamma(2 * u, 1 / nu, 1, 0, 0), 1 / nu)
             : lambda * pow(2 * R::qgamma(2 * u - 1, 1 / nu, 1, 1, 0), 1 / nu));
   }
+
+  // direct draw from the generator "gen" (see "RRng" and "Xoshiro"):
+  // |z| / lambda is (2 G)^(1 / nu) with G a Gamma(1 / nu, 1) draw, and the
+  // sign is drawn separately
+  template <typename Gen>
+  double rnd_direct(Gen& gen) {
+    double out = lambda * pow(2 * gen.gamma(1 / nu), 1 / nu);
+    return ((gen.unif() < 0.5) ? -out : out);
+  }
+
+  // inverse transform with the table of quantiles (must call "prep_table"
+  // first, on the main thread; "invsample_table" is free of the R API)
+  void prep_table() {
+    if (!table || table->par != nu) table = quantile_table(*this, nu);
+  }
+  double invsample_table(const double& u) { return table->get(u); }
 };
 
 #endif  // Ged.h
\ No newline at end of file
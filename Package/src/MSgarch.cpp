@@ -1,4 +1,36 @@
 #include "MSgarch.h"
+#include "MSgarchStatic.h"
+#include "sGARCH.h"
+#include "gjrGARCH.h"
+#include "Normal.h"
+#include "Student.h"
+#include "Symmetric.h"
+#include "Skewed.h"
+
+typedef SingleRegime<sGARCH<Symmetric<Normal> > > sGARCH_norm;
+typedef SingleRegime<sGARCH<Symmetric<Student> > > sGARCH_std;
+typedef SingleRegime<sGARCH<Skewed<Student> > > sGARCH_sstd;
+typedef SingleRegime<gjrGARCH<Symmetric<Normal> > > gjrGARCH_norm;
+typedef SingleRegime<gjrGARCH<Symmetric<Student> > > gjrGARCH_std;
+typedef SingleRegime<gjrGARCH<Skewed<Student> > > gjrGARCH_sstd;
+
+// combinations of models with a compiled loop for 'eval_model' (selected by
+// 'f_spec' from the name of the class); the other methods are the ones of
+// 'MSgarch'
+typedef MSgarchStatic<sGARCH_norm, sGARCH_norm> MSgarch_sGARCH_norm_sGARCH_norm;
+typedef MSgarchStatic<sGARCH_norm, sGARCH_norm, sGARCH_norm> MSgarch_sGARCH_norm_sGARCH_norm_sGARCH_norm;
+typedef MSgarchStatic<sGARCH_std, sGARCH_std> MSgarch_sGARCH_std_sGARCH_std;
+typedef MSgarchStatic<sGARCH_std, sGARCH_std, sGARCH_std> MSgarch_sGARCH_std_sGARCH_std_sGARCH_std;
+typedef MSgarchStatic<sGARCH_sstd, sGARCH_sstd> MSgarch_sGARCH_sstd_sGARCH_sstd;
+typedef MSgarchStatic<sGARCH_sstd, sGARCH_sstd, sGARCH_sstd> MSgarch_sGARCH_sstd_sGARCH_sstd_sGARCH_sstd;
+typedef MSgarchStatic<sGARCH_norm, sGARCH_std> MSgarch_sGARCH_norm_sGARCH_std;
+typedef MSgarchStatic<gjrGARCH_norm, gjrGARCH_norm> MSgarch_gjrGARCH_norm_gjrGARCH_norm;
+typedef MSgarchStatic<gjrGARCH_norm, gjrGARCH_norm, gjrGARCH_norm> MSgarch_gjrGARCH_norm_gjrGARCH_norm_gjrGARCH_norm;
+typedef MSgarchStatic<gjrGARCH_std, gjrGARCH_std> MSgarch_gjrGARCH_std_gjrGARCH_std;
+typedef MSgarchStatic<gjrGARCH_std, gjrGARCH_std, gjrGARCH_std> MSgarch_gjrGARCH_std_gjrGARCH_std_gjrGARCH_std;
+typedef MSgarchStatic<gjrGARCH_sstd, gjrGARCH_sstd> MSgarch_gjrGARCH_sstd_gjrGARCH_sstd;
+typedef MSgarchStatic<gjrGARCH_sstd, gjrGARCH_sstd, gjrGARCH_sstd> MSgarch_gjrGARCH_sstd_gjrGARCH_sstd_gjrGARCH_sstd;
+typedef MSgarchStatic<gjrGARCH_norm, gjrGARCH_std> MSgarch_gjrGARCH_norm_gjrGARCH_std;
 
 //===========================================================================//
 //===========================================================================//
@@ -21,12 +53,24 @@ RCPP_MODULE(MSgarch) {
       .method("f_get_Pstate", &MSgarch::f_get_Pstate)
       .method("f_sim", &MSgarch::f_sim)
       .method("f_simAhead", &MSgarch::f_simAhead)
+      .method("f_simAhead_filter", &MSgarch::f_simAhead_filter)
       .method("f_get_sd", &MSgarch::get_sd)
       .method("f_set_sd", &MSgarch::set_sd)
       .method("f_get_mean", &MSgarch::get_mean)
       .method("f_set_mean", &MSgarch::set_mean)
       .method("calc_ht", &MSgarch::calc_ht)
       .method("eval_model", &MSgarch::eval_model)
+      .method("eval_model_grad", &MSgarch::eval_model_grad)
+      .method("eval_model_score", &MSgarch::eval_model_score)
+      .method("f_mcmc", &MSgarch::f_mcmc)
+      .method("f_mcmc_chains", &MSgarch::f_mcmc_chains)
+      .method("f_filter_init", &MSgarch::f_filter_init)
+      .method("f_filter_update", &MSgarch::f_filter_update)
+      .method("f_forecast_var", &MSgarch::f_forecast_var)
+      .method("f_forecast_var_filter", &MSgarch::f_forecast_var_filter)
+      .method("f_pred_filter", &MSgarch::f_pred_filter)
+      .method("f_risk", &MSgarch::f_risk)
+      .method("f_risk_filter", &MSgarch::f_risk_filter)
       .method("ineq_func", &MSgarch::ineq_func)
       .method("f_pdf", &MSgarch::f_pdf)
       .method("f_pdf_its", &MSgarch::f_pdf_its)
@@ -34,4 +78,48 @@ RCPP_MODULE(MSgarch) {
       .method("f_cdf_its", &MSgarch::f_cdf_its)
       .method("f_rnd", &MSgarch::f_rnd)
       .method("f_unc_vol", &MSgarch::f_unc_vol);
+
+  // MS-GARCH with models known at compile time
+  class_<MSgarch_sGARCH_norm_sGARCH_norm>("MSgarch_sGARCH_norm_sGARCH_norm")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_sGARCH_norm_sGARCH_norm_sGARCH_norm>("MSgarch_sGARCH_norm_sGARCH_norm_sGARCH_norm")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_sGARCH_std_sGARCH_std>("MSgarch_sGARCH_std_sGARCH_std")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_sGARCH_std_sGARCH_std_sGARCH_std>("MSgarch_sGARCH_std_sGARCH_std_sGARCH_std")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_sGARCH_sstd_sGARCH_sstd>("MSgarch_sGARCH_sstd_sGARCH_sstd")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_sGARCH_sstd_sGARCH_sstd_sGARCH_sstd>("MSgarch_sGARCH_sstd_sGARCH_sstd_sGARCH_sstd")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_sGARCH_norm_sGARCH_std>("MSgarch_sGARCH_norm_sGARCH_std")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_gjrGARCH_norm_gjrGARCH_norm>("MSgarch_gjrGARCH_norm_gjrGARCH_norm")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_gjrGARCH_norm_gjrGARCH_norm_gjrGARCH_norm>("MSgarch_gjrGARCH_norm_gjrGARCH_norm_gjrGARCH_norm")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_gjrGARCH_std_gjrGARCH_std>("MSgarch_gjrGARCH_std_gjrGARCH_std")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_gjrGARCH_std_gjrGARCH_std_gjrGARCH_std>("MSgarch_gjrGARCH_std_gjrGARCH_std_gjrGARCH_std")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_gjrGARCH_sstd_gjrGARCH_sstd>("MSgarch_gjrGARCH_sstd_gjrGARCH_sstd")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_gjrGARCH_sstd_gjrGARCH_sstd_gjrGARCH_sstd>("MSgarch_gjrGARCH_sstd_gjrGARCH_sstd_gjrGARCH_sstd")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
+  class_<MSgarch_gjrGARCH_norm_gjrGARCH_std>("MSgarch_gjrGARCH_norm_gjrGARCH_std")
+      .derives<MSgarch>("MSgarch")
+      .constructor<List>();
 }
@@ -11,6 +11,188 @@ using namespace Rcpp;
 //======================================== AUXILIARY FUNCTIONS
 //============================================//
 
+// one step of the Hamilton filter on raw buffers (nothing is allocated):
+// given the filtered probabilities 'Pspot' at t-1, the row-major
+// transition-probability matrix 'P' and the kernels 'lnd[k * stride]' at t,
+// stores the one-step-ahead probabilities in 'Ppred', updates 'Pspot' and
+// returns the loglikelihood increment; 'N' is the number of states when
+// known at compile time (the buffers are then on the stack) and 0 otherwise,
+// in which case 'work' must hold 'K' doubles
+template <int N>
+inline double HamiltonStep(const int& K, const double* P, double* Pspot,
+                           double* Ppred, const double* lnd, const int& stride,
+                           double* work) {
+  const int n = ((N > 0) ? N : K);
+  double buf[(N > 0) ? N : 1];
+  double* tmp = ((N > 0) ? buf : work);
+  double min_lnd = lnd[0], delta, sum_tmp = 0;
+  for (int k = 1; k < n; k++) min_lnd = std::min(min_lnd, lnd[k * stride]);
+  delta = ((min_lnd < LND_MIN) ? LND_MIN - min_lnd
+             : 0);  // handle over/under-flows
+  for (int k = 0; k < n; k++) {
+    Ppred[k] = 0;  // one-step-ahead Prob(St | I(t-1))
+    for (int l = 0; l < n; l++) Ppred[k] += Pspot[l] * P[l * n + k];
+  }
+  for (int k = 0; k < n; k++) tmp[k] = lnd[k * stride] + delta;
+  for (int k = 0; k < n; k++) tmp[k] = exp(tmp[k]);
+  for (int k = 0; k < n; k++) {
+    tmp[k] *= Ppred[k];  // unormalized one-step-ahead Prob(St | I(t))
+    sum_tmp += tmp[k];
+  }
+  for (int k = 0; k < n; k++) Pspot[k] = tmp[k] / sum_tmp;
+  return -delta + log(sum_tmp);
+}
+
+// same, dispatched on the number of states 'K' (specialised up to 4)
+inline double HamiltonStepK(const int& K, const double* P, double* Pspot,
+                            double* Ppred, const double* lnd,
+                            const int& stride, double* work) {
+  switch (K) {
+    case 2: return HamiltonStep<2>(K, P, Pspot, Ppred, lnd, stride, work);
+    case 3: return HamiltonStep<3>(K, P, Pspot, Ppred, lnd, stride, work);
+    case 4: return HamiltonStep<4>(K, P, Pspot, Ppred, lnd, stride, work);
+    default: return HamiltonStep<0>(K, P, Pspot, Ppred, lnd, stride, work);
+  }
+}
+
+// 'nb' steps of the Hamilton filter in log space, filter 'b' having the
+// transition-probability matrix 'P + b K^2', the probabilities 'Pspot + b K'
+// and 'Ppred + b K' and the kernels 'lnd[b * stride_b + k * stride]': the
+// loglikelihood increment 'log(sum_k Ppred[k] exp(lnd[k]))', added to
+// 'out[b]', is the logsumexp of 'a[k] = log(Ppred[k]) + lnd[k]' shifted by
+// the maximum of 'a', so that no term under- or overflows whatever the
+// spread of the kernels. This costs K logarithms and K exponentials per
+// filter, evaluated for all the filters together by 'vec_log' and
+// 'vec_exp'; 'work' must hold '(2 K + 1) nb' doubles
+inline void HamiltonStepLog(const int& K, const int& nb, const double* P,
+                            double* Pspot, double* Ppred, const double* lnd,
+                            const int& stride_b, const int& stride,
+                            double* work, double* out) {
+  int n = nb * K;
+  double* a = work;            // log-probabilities, then shifted
+  double* e = work + n;        // their exponentials
+  double* a_max = work + 2 * n;
+  for (int b = 0; b < nb; b++) {
+    const double* P_mat = P + b * K * K;
+    for (int k = 0; k < K; k++) {
+      double tmp = 0;  // one-step-ahead Prob(St | I(t-1))
+      for (int l = 0; l < K; l++) tmp += Pspot[b * K + l] * P_mat[l * K + k];
+      Ppred[b * K + k] = tmp;
+    }
+  }
+  vec_log(Ppred, a, n);
+  for (int b = 0; b < nb; b++) {
+    double* a_b = a + b * K;
+    const double* lnd_b = lnd + b * stride_b;
+    for (int k = 0; k < K; k++) a_b[k] += lnd_b[k * stride];
+    a_max[b] = a_b[0];
+    for (int k = 1; k < K; k++) a_max[b] = std::max(a_max[b], a_b[k]);
+    for (int k = 0; k < K; k++) a_b[k] -= a_max[b];
+  }
+  vec_exp(a, e, n);
+  for (int b = 0; b < nb; b++) {
+    double* e_b = e + b * K;
+    double sum_e = 0;
+    for (int k = 0; k < K; k++) sum_e += e_b[k];
+    for (int k = 0; k < K; k++) Pspot[b * K + k] = e_b[k] / sum_e;
+    out[b] += a_max[b] + log(sum_e);
+  }
+}
+
+// Hamilton filter step with the algorithm set by 'filter_method'; 'work'
+// must hold '2 K + 1' doubles
+inline double FilterStep(const int& K, const double* P, double* Pspot,
+                         double* Ppred, const double* lnd, const int& stride,
+                         double* work) {
+  if (filter_method() == 1) {
+    double out = 0;
+    HamiltonStepLog(K, 1, P, Pspot, Ppred, lnd, 0, stride, work, &out);
+    return out;
+  }
+  return HamiltonStepK(K, P, Pspot, Ppred, lnd, stride, work);
+}
+
+// Hamilton filter from 'P0' over the 'n' columns of the K x n matrix of
+// kernels 'lnd' (stored by columns), as a parallel prefix scan over
+// 'nb_chunk' chunks of consecutive observations: over a chunk, the filter
+// is the product of the matrices 'P diag(exp(lnd_t))' applied to the
+// unnormalised probabilities. These products are first computed for all
+// the chunks in parallel (normalised at each step), the filtered
+// probabilities at the start of each chunk then follow sequentially from
+// them, and the chunks are finally filtered in parallel from these (see
+// 'FilterStep'), so that the results do not depend on 'nb_chunk' but for
+// rounding errors. The filtered and one-step-ahead probabilities of
+// column 't' are stored in 'Pspot + t K' and 'Ppred + t K' (both may be
+// null when only the loglikelihood is needed); returns the loglikelihood
+inline double HamiltonScan(const int& K, const double* P, const double* P0,
+                           const double* lnd, const int& n,
+                           const int& nb_chunk, double* Pspot,
+                           double* Ppred) {
+  std::vector<double> prod(nb_chunk * K * K);  // products of the chunks
+  std::vector<double> start((nb_chunk + 1) * K), lnd_chunk(nb_chunk);
+  std::copy(P0, P0 + K, start.begin());
+#pragma omp parallel for schedule(static) num_threads(nb_chunk)
+  for (int c = 0; c < nb_chunk - 1; c++) {  // the last one is not needed
+    double* A = &prod[c * K * K];
+    std::vector<double> B(K * K), e(K);
+    for (int i = 0; i < K * K; i++) A[i] = (i % (K + 1) == 0);  // identity
+    for (int t = (int)((double)n * c / nb_chunk);
+         t < (int)((double)n * (c + 1) / nb_chunk); t++) {
+      const double* lnd_t = lnd + (size_t)t * K;
+      double lnd_max = *std::max_element(lnd_t, lnd_t + K), A_max = 0;
+      for (int k = 0; k < K; k++) e[k] = exp(lnd_t[k] - lnd_max);
+      for (int i = 0; i < K; i++) {  // B = A P diag(e)
+        for (int k = 0; k < K; k++) {
+          double tmp = 0;
+          for (int l = 0; l < K; l++) tmp += A[i * K + l] * P[l * K + k];
+          B[i * K + k] = tmp * e[k];
+          A_max = std::max(A_max, B[i * K + k]);
+        }
+      }
+      for (int i = 0; i < K * K; i++) A[i] = B[i] / A_max;
+    }
+  }
+  for (int c = 0; c < nb_chunk - 1; c++) {  // start of the next chunk
+    double* next = &start[(c + 1) * K];
+    double sum = 0;
+    for (int k = 0; k < K; k++) {
+      next[k] = 0;
+      for (int l = 0; l < K; l++)
+        next[k] += start[c * K + l] * prod[c * K * K + l * K + k];
+      sum += next[k];
+    }
+    for (int k = 0; k < K; k++) next[k] /= sum;
+  }
+#pragma omp parallel for schedule(static) num_threads(nb_chunk)
+  for (int c = 0; c < nb_chunk; c++) {
+    std::vector<double> ps(&start[c * K], &start[c * K] + K), work(2 * K + 1);
+    std::vector<double> pp(K);
+    double tmp = 0;
+    for (int t = (int)((double)n * c / nb_chunk);
+         t < (int)((double)n * (c + 1) / nb_chunk); t++) {
+      tmp += FilterStep(K, P, &ps[0], ((Ppred) ? Ppred + (size_t)t * K : &pp[0]),
+                        lnd + (size_t)t * K, 1, &work[0]);
+      if (Pspot) std::copy(ps.begin(), ps.end(), Pspot + (size_t)t * K);
+    }
+    lnd_chunk[c] = tmp;
+  }
+  double out = 0;
+  for (int c = 0; c < nb_chunk; c++) out += lnd_chunk[c];
+  return out;
+}
+
+// stationary distribution 'P0' of the K x K transition-probability matrix
+// 'P' (stored by rows), solution of (I - P + U)' P0 = 1
+inline void StationaryProb(const int& K, const double* P, double* P0) {
+  arma::mat foo(K, K);
+  for (int i = 0; i < K; i++)
+    for (int l = 0; l < K; l++) foo(i, l) = (i == l) - P[l * K + i] + 1;
+  arma::vec Uvec(K);
+  Uvec.fill(1);
+  arma::vec delta = (foo).i() * Uvec;
+  for (int i = 0; i < K; i++) P0[i] = delta(i);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //========================================== MS-GARCH class
 //===============================================//
@@ -19,16 +201,70 @@ using namespace Rcpp;
 typedef std::vector<Base*> many;
 typedef std::vector<volatility> volatilityVector;
 
+// number of vectors of parameters evaluated together in 'eval_model'
+#define MSGARCH_BATCH_SIZE 64
+// number of observations whose kernels are computed together in
+// 'filter_batch_impl' (at most KERNEL_BLOCK_SIZE)
+#define MSGARCH_STEP_BLOCK 64
+// minimum number of observations per chunk of the parallel filter of
+// 'f_get_Pstate' (see 'HamiltonScan')
+#define MSGARCH_SCAN_MIN 4096
+
+class MSgarchInstance;
+
 // MS-GARCH class
 class MSgarch {
+protected:
   many specs;           // vector of pointers to Base objects
   int K;                // number of models
-  NumericMatrix P;      // transition-probability matrix
-  NumericVector PLast;  // all transition-probability matrix at each step
-  NumericVector P0;     // initial distribution of states
   double P_mean;        // mean for the prior on transition-probabilities
   double P_sd;          // sd for the prior on transition-probabilities
   double LND_MIN;       // minimum loglikelihood allowed
+  
+  friend class MSgarchInstance;
+
+  // Hamilton filter step (see 'FilterStep')
+  double filter_step(const double* P_mat, double* Pspot, double* Ppred,
+                     const double* lnd, const int& stride, double* work) const {
+    return FilterStep(K, P_mat, Pspot, Ppred, lnd, stride, work);
+  }
+
+  // stores the volatilities and probabilities of row 'j' of a filter state
+  void filter_store(const int&, const MSgarchInstance&,
+                    const volatilityVector&, const double*, NumericMatrix&,
+                    NumericMatrix&, NumericMatrix&, NumericMatrix&,
+                    NumericMatrix&) const;
+
+  // path 'i' of 'n' observations of the models 'mod' of the instance 'inst'
+  // (see 'sim_parallel'); the states and innovations are drawn from 'gen',
+  // the innovations by the method 'method' (see 'rnd_method'), or inverted
+  // from the uniforms 'u[0]' to 'u[2 n - 1]' if 'u' is not null. The serial
+  // and parallel simulators share it, so that their draws differ by the
+  // stream only
+  template <typename Gen>
+  void sim_path(const MSgarchInstance&, Base* const*, Gen&, const int&,
+                const double*, const double*, const double*, const int&,
+                const int&, const volatilityVector*, NumericMatrix&,
+                NumericMatrix&, arma::cube&) const;
+  // simulation of the paths on several threads, or on the main thread from
+  // R's RNG (see 'f_sim')
+  void sim_parallel(const MSgarchInstance&, const int&, const int&,
+                    const double*, const volatilityVector*, NumericMatrix&,
+                    NumericMatrix&, arma::cube&, const double* = NULL) const;
+  void sim_serial(const MSgarchInstance&, const int&, const int&,
+                  const double*, const volatilityVector*, NumericMatrix&,
+                  NumericMatrix&, arma::cube&) const;
+  // paths from one-step-ahead volatilities and probabilities (see
+  // 'f_simAhead')
+  List sim_ahead(const MSgarchInstance&, const volatilityVector&,
+                 const double*, const int&, const int&) const;
+
+  // block filter where 'Regimes::step' increments the volatilities and
+  // computes the kernels of all models at one observation
+  template <typename Regimes>
+  void filter_batch_impl(const double*, const int&, const int&, const double*,
+                         const double*, Base* const*, const int&,
+                         double*) const;
 public:
   std::vector<std::string> name;
   NumericVector theta0;
@@ -66,8 +302,6 @@ public:
       NbParams.push_back((*it)->spec_nb_coeffs());
       NbParamsModel.push_back((*it)->spec_nb_coeffs_model());
     }
-    P0 = rep(1.0 / K, K);
-    PLast = rep(1.0 / K, K);
     P_mean = 1 / K;
     P_sd = 100;
     LND_MIN = log(DBL_MIN) + 1;
@@ -94,55 +328,6 @@ public:
     }
   }
   
-  // set the parameters (including those of the distribution) of all models
-  // the last elements of theta should be those of the transition-probability
-  // matrix
-  // this function should always be called first
-  void loadparam(const NumericVector&);
-  
-  // to be called before 'calc_prior', 'ineq_func' or 'set_vol'
-  void prep_ineq_vol() {
-    for (many::iterator it = specs.begin(); it != specs.end(); ++it)
-      (*it)->spec_prep_ineq_vol();
-  }
-  
-  // to be called before 'calc_kernel'
-  void prep_kernel() {
-    for (many::iterator it = specs.begin(); it != specs.end(); ++it)
-      (*it)->spec_prep_kernel();
-  }
-  
-  // loglikelihood of a single observation for all models
-  NumericVector calc_kernel(const volatilityVector& vol, const double& yi) {
-    NumericVector lnd(K);
-    int k = 0;
-    for (many::iterator it = specs.begin(); it != specs.end(); ++it) {
-      lnd[k] = (*it)->spec_calc_kernel(vol[k], yi);
-      k++;
-    }
-    return lnd;
-  }
-  
-  // initialize all volatilities to their undonditional expected value
-  volatilityVector set_vol(const double& y0) {
-    volatilityVector vol(K);
-    int k = 0;
-    for (many::iterator it = specs.begin(); it != specs.end(); ++it) {
-      vol[k] = (*it)->spec_set_vol(y0);
-      k++;
-    }
-    return vol;
-  }
-  
-  // increment all volatilities
-  void increment_vol(volatilityVector& vol, const double& yim1) {
-    int k = 0;
-    for (many::iterator it = specs.begin(); it != specs.end(); ++it) {
-      (*it)->spec_increment_vol(vol[k], yim1);
-      k++;
-    }
-  }
-  
   NumericVector get_mean() {
     NumericVector out;
     for (many::iterator it = specs.begin(); it != specs.end();
@@ -182,7 +367,8 @@ public:
   }
   
   // extract parameter vector of model 'k', where k is in [0, K-1]
-  NumericVector extract_theta_it(const NumericVector& theta, const int& k) {
+  NumericVector extract_theta_it(const NumericVector& theta,
+                                 const int& k) const {
     int start = MyCumsum(NbParams, k);
     NumericVector theta_it(theta.begin() + start,
                            theta.begin() + start + NbParams[k]);
@@ -190,7 +376,7 @@ public:
   }
   
   // extract transition-probability from state 'k', where k is in [0, K-1]
-  NumericVector extract_P_it(const NumericVector& theta, const int& k) {
+  NumericVector extract_P_it(const NumericVector& theta, const int& k) const {
     int Tot_NbParams = sum(NbParams);
     NumericVector P_it(theta.begin() + Tot_NbParams + k * (K - 1),
                        theta.begin() + Tot_NbParams + (k + 1) * (K - 1));
@@ -198,34 +384,15 @@ public:
     return P_it;
   }
   
-  // simulate a random inovation from model 'k', where k is in [0, K-1]
-  double rndgen(const int& k) {
-    many::iterator it = specs.begin() + k;
-    return (*it)->spec_rndgen(1)[0];
-  }
-  
   // inequality function
-  NumericVector ineq_func(const NumericVector& theta) {
-    NumericVector out;
-    loadparam(theta);
-    prep_ineq_vol();
-    for (many::iterator it = specs.begin(); it != specs.end(); ++it)
-      out.push_back((*it)->spec_ineq_func());
-    if (K > 1) {
-      NumericMatrix Psub = P(Range(0, K - 1), Range(0, K - 2));
-      for (int i = 0; i < K; i++) out.push_back(sum(Psub(i, _)));
-    }
-    return out;
-  }
-  
-  NumericVector get_p_last() { return PLast; }
+  NumericVector ineq_func(const NumericVector& theta);
   
   int get_K() { return K; }
   
   List f_get_Pstate(const NumericVector&, const NumericVector&);
   
-  // check prior
-  prior calc_prior(const NumericVector&);
+  // check prior of the parameters 'theta' loaded in an instance
+  prior calc_prior(const MSgarchInstance&, const NumericVector&) const;
   
   arma::cube calc_ht(NumericMatrix&, const NumericVector&);
   
@@ -246,58 +413,239 @@ public:
   
   Rcpp::List f_simAhead(const NumericVector&, const int&,  const int&, const NumericVector&,
                         const NumericVector&);
+  Rcpp::List f_simAhead_filter(const List&, const int&, const int&,
+                               const int&, const NumericVector&);
   
   Rcpp::List f_rnd(const int&, const NumericVector&, const NumericVector&);
-  // compute loglikelihood matrix
-  NumericMatrix calc_lndMat(const NumericVector&);
   
   NumericMatrix f_unc_vol(NumericMatrix&, const NumericVector&);
   
   // apply Hamilton filter
-  double HamiltonFilter(const NumericMatrix&);
+  double HamiltonFilter(const MSgarchInstance&, const NumericVector&,
+                        volatilityVector&) const;
+  // kernels of all the models along the data, computed in parallel (see
+  // 'f_get_Pstate'), and the loglikelihood filtered from them by the
+  // parallel scan (see 'filter_scan')
+  void calc_lnd_mat(const MSgarchInstance&, const NumericVector&,
+                    double*) const;
+  double HamiltonFilterScan(const MSgarchInstance&, const NumericVector&) const;
   
   // Model evaluation
   NumericVector eval_model(NumericMatrix&, const NumericVector&, const bool&);
+  
+  // loglikelihood and its gradient, and contributions of each observation
+  // to the gradient
+  List eval_model_grad(NumericMatrix&, const NumericVector&, const bool&);
+  NumericMatrix eval_model_score(const NumericVector&, const NumericVector&);
+  
+  // kernel of a single vector of parameters, and adaptive Metropolis sampler
+  double eval_theta(const NumericVector&, const NumericVector&, const bool&);
+  NumericMatrix f_mcmc(const NumericVector& y, const NumericVector& par0,
+                       const List& mapping, const int& n,
+                       const double& acc_rate) {
+    return ram_sampler(*this, y, par0, mapping, n, acc_rate);
+  }
+  List f_mcmc_chains(const NumericVector& y, const NumericMatrix& par0,
+                     const List& mapping, const int& n,
+                     const double& acc_rate) {
+    return ram_sampler_chains(*this, y, par0, mapping, n, acc_rate);
+  }
+  double calc_lnd_grad(const MSgarchInstance&, const NumericVector&,
+                       const NumericVector&, double*, double*) const;
+
+  // state of the Hamilton filter after 'y' for each vector of parameters,
+  // and the same state advanced by new observations
+  List f_filter_init(NumericMatrix&, const NumericVector&);
+  List f_filter_update(NumericMatrix&, const List&, const NumericVector&);
+
+  // expected variance of the 'n_ahead' next observations after 'y', or
+  // after a filter state
+  NumericMatrix f_forecast_var(NumericMatrix&, const NumericVector&,
+                               const int&);
+  NumericMatrix f_forecast_var_filter(NumericMatrix&, const List&,
+                                      const int&);
+
+  // predictive PDF (or CDF) at 'x' one step after a filter state
+  NumericVector f_pred_filter(const NumericVector&, NumericMatrix&,
+                              const List&, const bool&);
+
+  // Value-at-Risk and Expected-shortfall of the predictive distribution
+  List f_risk(NumericMatrix&, const NumericVector&, const NumericVector&,
+              const bool&, const bool&);
+  List f_risk_filter(NumericMatrix&, const List&, const NumericVector&,
+                     const bool&);
+  
+  // loglikelihood of a block of loaded models in a single pass over the data
+  virtual void filter_batch(const double*, const int&, const int&,
+                            const double*, const double*, Base* const*,
+                            const int&, double*) const;
+  
+  virtual ~MSgarch() {}
 };
 
-//---------------------- load parameters of all models  ----------------------//
-inline void MSgarch::loadparam(const NumericVector& theta) {
-  // load the parameters of each model and the transition-probability matrix
-  NumericMatrix P_mat(K, K);
-  int k = 0;
-  for (many::iterator it = specs.begin(); it != specs.end();
-  ++it) {  // loop over models
-    NumericVector theta_it =
-    extract_theta_it(theta, k);  // parameters of model 'it'
-    NumericVector P_it =
-      extract_P_it(theta, k);  // transition probabilities from model 'it'
-    (*it)->spec_loadparam(theta_it);
-    P_mat(k, _) = P_it;
-    k++;
+// volatility and kernel steps of a block of copies of the models over the
+// 'n' observations 'y[0]' to 'y[n - 1]' (the volatilities being incremented
+// from 'y[-1]' to 'y[n - 2]', in two phases as in 'SingleRegime::calc_lnd'),
+// through the virtual interface of 'Base'; the
+// kernel of copy 'kb' at 'y[i]' is 'lnd_k[kb * MSGARCH_STEP_BLOCK + i]'
+struct DynamicRegimes {
+  static void step(Base* const* batch, const int& K, const int& nb,
+                   const int& nb_block, volatility* vol, double* lnd_k,
+                   const double* y, const int& n) {
+    double h[MSGARCH_STEP_BLOCK], lnh[MSGARCH_STEP_BLOCK];
+    for (int k = 0; k < K; k++) {
+      for (int b = 0; b < nb; b++) {
+        int kb = k * nb_block + b;
+        for (int i = 0; i < n; i++) {
+          batch[kb]->spec_increment_h(vol[kb], y[i - 1]);
+          h[i] = vol[kb].h, lnh[i] = vol[kb].lnh;
+        }
+        batch[kb]->spec_set_lnh_block(h, lnh, n);
+        batch[kb]->spec_calc_kernel_block(h, lnh, y,
+                                          lnd_k + kb * MSGARCH_STEP_BLOCK, n);
+      }
+    }
   }
-  P = P_mat;
-  arma::mat I = arma::eye(K,K);
-  arma::mat Umat = arma::ones(K,K);
-    arma::vec Uvec(K);
-  Uvec.fill(1);
-  arma::mat foo = (I - as<arma::mat>(P_mat) + Umat).t();
-  
-  arma::vec delta = (foo).i() * Uvec;
-  for(int i = 0; i < K; i++){
-    P0(i) = delta(i);
+};
+
+//------------------------------------- Model instance
+//-------------------------------------//
+// copies of the models of an 'MSgarch' with one vector of parameters loaded,
+// with their transition-probability matrix and initial distribution. The
+// methods that filter, evaluate or simulate given parameters work on an
+// instance of their own and never load them into the models shared through
+// the R objects: they keep no state between calls and are reentrant.
+// Copying the models calls the R API, so that an instance is built and
+// destroyed on the main thread; in between, it can be used on any thread
+class MSgarchInstance {
+  MSgarchInstance(const MSgarchInstance&);  // not copyable
+  MSgarchInstance& operator=(const MSgarchInstance&);
+
+ public:
+  int K;                             // number of models
+  many models;                       // copies of the models
+  std::vector<double> P_row;         // transition-probability matrix, by rows
+  std::vector<double> P_alias_prob;  // alias tables of its rows (see
+  std::vector<int> P_alias;          // 'sampleAlias')
+  std::vector<double> P0;            // initial distribution of states
+
+  MSgarchInstance(const MSgarch& ms, const NumericVector& theta)
+      : K(ms.K), models(ms.K), P_row(ms.K * ms.K),
+        P_alias_prob(ms.K * ms.K), P_alias(ms.K * ms.K), P0(ms.K) {
+    for (int k = 0; k < K; k++) {
+      models[k] = ms.specs[k]->clone();
+      models[k]->spec_loadparam(ms.extract_theta_it(theta, k));
+      models[k]->spec_prep_ineq_vol();
+      models[k]->spec_prep_kernel();
+      NumericVector P_it = ms.extract_P_it(theta, k);
+      for (int l = 0; l < K; l++) P_row[k * K + l] = P_it[l];
+    }
+    for (int k = 0; k < K; k++)
+      build_alias(&P_row[k * K], K, &P_alias_prob[k * K], &P_alias[k * K]);
+    StationaryProb(K, &P_row[0], &P0[0]);
+  }
+
+  ~MSgarchInstance() {
+    for (many::iterator it = models.begin(); it != models.end(); ++it)
+      delete *it;
+  }
+
+  // volatilities of all models at their unconditional expected value
+  volatilityVector set_vol(const double& y0) const {
+    volatilityVector vol(K);
+    for (int k = 0; k < K; k++) vol[k] = models[k]->spec_set_vol(y0);
+    return vol;
+  }
+
+  // increment all volatilities
+  void increment_vol(volatilityVector& vol, const double& yim1) const {
+    for (int k = 0; k < K; k++) models[k]->spec_increment_vol(vol[k], yim1);
+  }
+
+  // one-step-ahead probabilities 'Ppred' of the filtered ones 'Pspot'
+  void predict(const double* Pspot, double* Ppred) const {
+    for (int k = 0; k < K; k++) {
+      Ppred[k] = 0;
+      for (int l = 0; l < K; l++) Ppred[k] += Pspot[l] * P_row[l * K + k];
+    }
+  }
+
+  // one step of the Hamilton filter (see 'FilterStep')
+  double filter_step(double* Pspot, double* Ppred, const double* lnd,
+                     double* work) const {
+    return FilterStep(K, &P_row[0], Pspot, Ppred, lnd, 1, work);
+  }
+
+  // Hamilton filter over 'y' from 'P0': returns the loglikelihood and
+  // leaves the one-step-ahead volatilities in 'vol' and probabilities in
+  // 'Ppred'
+  double filter(const NumericVector& y, volatilityVector& vol,
+                double* Ppred) const {
+    int nb_obs = y.size();
+    double lnd = 0;
+    std::vector<double> Pspot(P0), lndCol(K), work(2 * K + 1);
+    vol = set_vol(y[0]);
+    for (int t = 1; t < nb_obs; t++) {
+      for (int k = 0; k < K; k++) {
+        models[k]->spec_increment_vol(vol[k], y[t - 1]);
+        lndCol[k] = models[k]->spec_calc_kernel(vol[k], y[t]);
+      }
+      lnd += filter_step(&Pspot[0], Ppred, &lndCol[0], &work[0]);
+    }
+    if (nb_obs > 0) increment_vol(vol, y[nb_obs - 1]);
+    predict(&Pspot[0], Ppred);
+    return lnd;
+  }
+
+  // advances the volatilities and the filtered probabilities 'Pspot' over the
+  // 'n' observations 'y' (the volatilities must be those of 'y[0]'); returns
+  // the loglikelihood increment
+  double advance(volatilityVector& vol, double* Pspot, const double* y,
+                 const int& n) const {
+    double lnd = 0;
+    std::vector<double> Ppred(K), lndCol(K), work(2 * K + 1);
+    for (int t = 0; t < n; t++) {
+      for (int k = 0; k < K; k++)
+        lndCol[k] = models[k]->spec_calc_kernel(vol[k], y[t]);
+      lnd += filter_step(Pspot, &Ppred[0], &lndCol[0], &work[0]);
+      increment_vol(vol, y[t]);  // one-step-ahead volatilities
+    }
+    return lnd;
+  }
+
+  // next state given the state 's' and a uniform draw
+  int sample_next(const int& s, const double& u) const {
+    return sampleAlias(&P_alias_prob[s * K], &P_alias[s * K], K, u);
+  }
+};
+
+//------------------------------ Inequality function
+//------------------------------//
+inline NumericVector MSgarch::ineq_func(const NumericVector& theta) {
+  NumericVector out;
+  MSgarchInstance inst(*this, theta);  // load parameters
+  for (int k = 0; k < K; k++) out.push_back(inst.models[k]->spec_ineq_func());
+  if (K > 1) {
+    for (int i = 0; i < K; i++) {
+      double sum_P = 0;  // sum of the free transition probabilities
+      for (int l = 0; l < K - 1; l++) sum_P += inst.P_row[i * K + l];
+      out.push_back(sum_P);
+    }
   }
+  return out;
 }
 
 //------------------------------ Prior calculation
 //------------------------------//
-inline prior MSgarch::calc_prior(const NumericVector& theta) {
+inline prior MSgarch::calc_prior(const MSgarchInstance& inst,
+                                 const NumericVector& theta) const {
   // compute prior of individual models
   bool r1_joint = 1;    // joint r1 of the models
   double r2_joint = 0;  // joint r2 of the models
   double r3_joint = 0;
   int k = 0;
   prior pr;
-  for (many::iterator it = specs.begin(); it != specs.end();
+  for (many::const_iterator it = inst.models.begin(); it != inst.models.end();
   ++it) {  // loop over models
     NumericVector theta_it =
     extract_theta_it(theta, k);  // parameters of model 'it'
@@ -319,7 +667,6 @@ inline prior MSgarch::calc_prior(const NumericVector& theta) {
 
 inline NumericMatrix MSgarch::f_unc_vol(NumericMatrix& all_thetas,
                                         const NumericVector& y) {
-  int K = get_K();
   int nb_thetas = all_thetas.nrow();
   volatilityVector vol;
   NumericVector theta_j;
@@ -327,9 +674,8 @@ inline NumericMatrix MSgarch::f_unc_vol(NumericMatrix& all_thetas,
   
   for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
     theta_j = all_thetas(j, _);
-    loadparam(theta_j);
-    prep_ineq_vol();
-    vol = set_vol(y[0]);
+    MSgarchInstance inst(*this, theta_j);
+    vol = inst.set_vol(y[0]);
     // initialize volatility
     for (int s = 0; s < K; s++) {
       ht(j, s) = vol[s].h;
@@ -340,7 +686,6 @@ inline NumericMatrix MSgarch::f_unc_vol(NumericMatrix& all_thetas,
 
 inline arma::cube MSgarch::calc_ht(NumericMatrix& all_thetas,
                                    const NumericVector& y) {
-  int K = get_K();
   int nb_obs = y.size();
   int nb_thetas = all_thetas.nrow();
   volatilityVector vol;
@@ -349,16 +694,15 @@ inline arma::cube MSgarch::calc_ht(NumericMatrix& all_thetas,
   
   for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
     theta_j = all_thetas(j, _);
-    loadparam(theta_j);
-    prep_ineq_vol();
-    vol = set_vol(y[0]);
+    MSgarchInstance inst(*this, theta_j);
+    vol = inst.set_vol(y[0]);
     // initialize volatility
     for (int s = 0; s < K; s++) {
       ht(0, j, s) = vol[s].h;
     }
     
     for (int i = 1; i <= nb_obs; i++) {  // loop over observations
-      increment_vol(vol, y[i - 1]);      // increment all volatilities
+      inst.increment_vol(vol, y[i - 1]);  // increment all volatilities
       
       for (int s = 0; s < K; s++) {
         ht(i, j, s) = vol[s].h;
@@ -375,24 +719,20 @@ inline NumericVector MSgarch::f_pdf(const NumericVector& x,
   // computes volatility
   int s = 0;
   int nx = x.size();
-  int ny = y.size();
   double sig;
   NumericVector tmp(nx);
   NumericVector out(nx);
-  loadparam(theta);  // load parameters
-  prep_ineq_vol();   // prepare functions related to volatility
-  volatilityVector vol = set_vol(y[0]);  // initialize volatility
-  
-  for (int t = 0; t < ny; t++) increment_vol(vol, y[t]);
-  
-  HamiltonFilter(calc_lndMat(y));
+  MSgarchInstance inst(*this, theta);  // load parameters
+  volatilityVector vol;
+  std::vector<double> Ppred(K);
+  inst.filter(y, vol, &Ppred[0]);  // one-step-ahead volatilities and probabilities
   
-  for (many::iterator it = specs.begin(); it != specs.end(); ++it) {
+  for (many::iterator it = inst.models.begin(); it != inst.models.end(); ++it) {
     sig = sqrt(vol[s].h);
     // computes PDF
     for (int i = 0; i < nx; i++) {
       tmp[i] = (*it)->spec_calc_pdf(x[i] / sig) / sig;  //
-      out[i] = out[i] + tmp[i] * PLast[s];
+      out[i] = out[i] + tmp[i] * Ppred[s];
     }
     s++;
   }
@@ -416,11 +756,10 @@ inline arma::cube MSgarch::f_pdf_its(const NumericVector& theta,
   int nx = x.nrow();
   double sig;
   arma::cube tmp(nx, ny, K);
-  loadparam(theta);  // load parameters
-  prep_ineq_vol();   // prepare functions related to volatility
-  volatilityVector vol = set_vol(y[0]);  // initialize volatility
+  MSgarchInstance inst(*this, theta);         // load parameters
+  volatilityVector vol = inst.set_vol(y[0]);  // initialize volatility
   
-  for (many::iterator it = specs.begin(); it != specs.end(); ++it) {
+  for (many::iterator it = inst.models.begin(); it != inst.models.end(); ++it) {
     sig = sqrt(vol[s].h);
     for (int ix = 0; ix < nx; ix++) {
       tmp(ix, 0, s) = (*it)->spec_calc_pdf(x(ix, 0) / sig) / sig;  //
@@ -430,8 +769,8 @@ inline arma::cube MSgarch::f_pdf_its(const NumericVector& theta,
   
   for (int i = 1; i < ny; i++) {
     s = 0;
-    increment_vol(vol, y[i - 1]);
-    for (many::iterator it = specs.begin(); it != specs.end(); ++it) {
+    inst.increment_vol(vol, y[i - 1]);
+    for (many::iterator it = inst.models.begin(); it != inst.models.end(); ++it) {
       sig = sqrt(vol[s].h);
       for (int ix = 0; ix < nx; ix++) {
         tmp(ix, i, s) = (*it)->spec_calc_pdf(x(ix, i) / sig) / sig;  //
@@ -450,24 +789,20 @@ inline NumericVector MSgarch::f_cdf(const NumericVector& x,
   // computes volatility
   int s = 0;
   int nx = x.size();
-  int ny = y.size();
   double sig;
   NumericVector tmp(nx);
   NumericVector out(nx);
-  loadparam(theta);  // load parameters
-  prep_ineq_vol();   // prepare functions related to volatility
-  volatilityVector vol = set_vol(y[0]);  // initialize volatility
-  
-  for (int t = 0; t < ny; t++) increment_vol(vol, y[t]);
-  
-  HamiltonFilter(calc_lndMat(y));
+  MSgarchInstance inst(*this, theta);  // load parameters
+  volatilityVector vol;
+  std::vector<double> Ppred(K);
+  inst.filter(y, vol, &Ppred[0]);  // one-step-ahead volatilities and probabilities
   
-  for (many::iterator it = specs.begin(); it != specs.end(); ++it) {
+  for (many::iterator it = inst.models.begin(); it != inst.models.end(); ++it) {
     sig = sqrt(vol[s].h);
     // computes CDF
     for (int i = 0; i < nx; i++) {
       tmp[i] = (*it)->spec_calc_cdf(x[i] / sig);
-      out[i] = out[i] + tmp[i] * PLast[s];
+      out[i] = out[i] + tmp[i] * Ppred[s];
     }
     s++;
   }
@@ -491,10 +826,9 @@ inline arma::cube MSgarch::f_cdf_its(const NumericVector& theta,
   double sig;
   int nx = x.nrow();
   arma::cube tmp(nx, ny, K);
-  loadparam(theta);  // load parameters
-  prep_ineq_vol();   // prepare functions related to volatility
-  volatilityVector vol = set_vol(y[0]);  // initialize volatility
-  for (many::iterator it = specs.begin(); it != specs.end(); ++it) {
+  MSgarchInstance inst(*this, theta);         // load parameters
+  volatilityVector vol = inst.set_vol(y[0]);  // initialize volatility
+  for (many::iterator it = inst.models.begin(); it != inst.models.end(); ++it) {
     sig = sqrt(vol[s].h);
     for (int ix = 0; ix < nx; ix++) {
       tmp(ix, 0, s) = (*it)->spec_calc_cdf(x(ix, 0) / sig);  //
@@ -503,8 +837,8 @@ inline arma::cube MSgarch::f_cdf_its(const NumericVector& theta,
   }
   for (int i = 1; i < ny; i++) {
     s = 0;
-    increment_vol(vol, y[i - 1]);
-    for (many::iterator it = specs.begin(); it != specs.end(); ++it) {
+    inst.increment_vol(vol, y[i - 1]);
+    for (many::iterator it = inst.models.begin(); it != inst.models.end(); ++it) {
       sig = sqrt(vol[s].h);
       for (int ix = 0; ix < nx; ix++) {
         tmp(ix, i, s) = (*it)->spec_calc_cdf(x(ix, i) / sig);  //
@@ -518,240 +852,653 @@ inline arma::cube MSgarch::f_cdf_its(const NumericVector& theta,
 
 //------------------------------ Model simulation
 //------------------------------//
+template <typename Gen>
+inline void MSgarch::sim_path(const MSgarchInstance& inst, Base* const* mod,
+                              Gen& gen, const int& method, const double* cum0,
+                              const double* cumP, const double* u,
+                              const int& n, const int& i,
+                              const volatilityVector* vol0, NumericMatrix& y,
+                              NumericMatrix& S, arma::cube& CondVol) const {
+  volatilityVector vol(K);
+  int s = sampleCum(cum0, K, ((u) ? *u++ : gen.unif()));
+  double z = ((u) ? mod[s]->spec_invsample_table(*u++)
+                  : mod[s]->spec_draw(gen, method));
+  for (int k = 0; k < K; k++)
+    vol[k] = ((vol0) ? (*vol0)[k] : mod[k]->spec_set_vol(z));
+  for (int t = 0; t < n; t++) {
+    if (t > 0) {
+      s = ((u) ? sampleCum(&cumP[s * K], K, *u++)
+               : inst.sample_next(s, gen.unif()));
+      z = ((u) ? mod[s]->spec_invsample_table(*u++)
+               : mod[s]->spec_draw(gen, method));
+      for (int k = 0; k < K; k++)
+        mod[k]->spec_increment_vol(vol[k], y(i, t - 1));
+    }
+    S(i, t) = s;
+    y(i, t) = z * sqrt(vol[s].h);
+    for (int k = 0; k < K; k++) CondVol(i, t, k) = sqrt(vol[k].h);
+  }
+}
+
+inline void MSgarch::sim_serial(const MSgarchInstance& inst, const int& n,
+                                const int& m, const double* cum0,
+                                const volatilityVector* vol0, NumericMatrix& y,
+                                NumericMatrix& S, arma::cube& CondVol) const {
+  RRng gen;
+  for (int k = 0; k < K; k++) inst.models[k]->spec_prep_rnd();
+  for (int i = 0; i < m; i++)
+    sim_path(inst, &inst.models[0], gen, rnd_method(), cum0, NULL, NULL, n,
+             i, vol0, y, S, CondVol);
+}
+
+// with more than one thread (see 'SetThreads'), the simulators draw from the
+// random streams of 'Rng.h' (seeded from R's RNG) instead of R's RNG: the
+// 'm' paths of length 'n' are simulated in parallel by blocks of
+// SIM_BLOCK_SIZE paths with one stream each, on one copy of the models per
+// thread; 'cum0' are the cumulative probabilities of the first state, and
+// the paths start from the volatilities 'vol0' or, if null, from those set
+// by their first innovation. If 'u' is not null, the '2 n' draws of path
+// 'i' (state then innovation at each step) are the uniforms 'u[i * 2 n]' to
+// 'u[i * 2 n + 2 n - 1]' (see 'sim_uniforms'), and the transitions are then
+// sampled by inversion of their cumulative probabilities, which is monotone
+// in the uniforms. The innovations are drawn by the method
+// 'rnd_method_thread', the exact inverse transform falling back to the tables
+// of quantiles, and the uniforms 'u' are inverted on these tables; they are
+// built beforehand on the main thread, so that the workers never call the R
+// API
+inline void MSgarch::sim_parallel(const MSgarchInstance& inst, const int& n,
+                                  const int& m, const double* cum0,
+                                  const volatilityVector* vol0,
+                                  NumericMatrix& y, NumericMatrix& S,
+                                  arma::cube& CondVol, const double* u) const {
+  int nb_thread = std::max(1, nb_threads());
+  std::vector<double> cumP(K * K);
+  cumulate_rows(&inst.P_row[0], K, K, &cumP[0]);
+  int nb_blocks = (m + SIM_BLOCK_SIZE - 1) / SIM_BLOCK_SIZE;
+  std::vector<Xoshiro> rng = make_streams(nb_blocks);
+  int method = ((u) ? 2 : rnd_method_thread());
+  many local(K * nb_thread);  // 'local[i * K + k]' for thread i
+  if (method == 2)
+    for (int k = 0; k < K; k++) inst.models[k]->spec_prep_table();
+  for (int i = 0; i < nb_thread; i++)
+    for (int k = 0; k < K; k++) local[i * K + k] = inst.models[k]->clone();
+#pragma omp parallel for schedule(dynamic) num_threads(nb_thread)
+  for (int b = 0; b < nb_blocks; b++) {
+    Base* const* mod = &local[thread_id() * K];
+    int i_end = std::min(m, (b + 1) * SIM_BLOCK_SIZE);
+    for (int i = b * SIM_BLOCK_SIZE; i < i_end; i++)
+      sim_path(inst, mod, rng[b], method, cum0, &cumP[0],
+               ((u) ? u + (size_t)i * 2 * n : NULL), n, i, vol0, y, S,
+               CondVol);
+  }
+  for (many::iterator it = local.begin(); it != local.end(); ++it) delete *it;
+}
+
 inline List MSgarch::f_sim(const int& n, const int& m, const NumericVector& theta) {
   // setup
-  K = get_K();
   NumericMatrix y(m,n);  // observations
   NumericMatrix S(m,n);  // states of the Markov chain
   arma::cube CondVol(m,n,K);
-  loadparam(theta);       // load parameters
-  
-  // generate first draw
-  double z;            // random innovation from initial state
-  prep_ineq_vol();                    // prep for 'set_vol'
-  volatilityVector vol;  // initialize all volatilities
-  for (int i = 0; i < m; i++) {
-    S(i,0) = sampleState(P0);             // sample initial state
-    z = rndgen(S(i,0));
-    vol = set_vol(z);
-    for (int s = 0; s < K; s++) {
-      CondVol(i, 0, s) = sqrt(vol[s].h);
-    }
-    y(i,0) = z * sqrt(vol[S(i,0)].h);
-    for (int t = 1; t < n; t++) {
-      S(i,t) = sampleState(P(S(i,t - 1), _));  // sample new state
-      z = rndgen(S(i,t));                    // sample new innovation
-      increment_vol(vol, y(i,t - 1));        // increment all volatilities
-      y(i,t) = z * sqrt(vol[S(i,t)].h);        // new draw
-      for (int s = 0; s < K; s++) {
-        CondVol(i, t, s) = sqrt(vol[s].h);
-      }
-    }
+  MSgarchInstance inst(*this, theta);  // load parameters
+  
+  // cumulative probabilities of the initial state
+  std::vector<double> cumP0(K);
+  cumulate_rows(&inst.P0[0], 1, K, &cumP0[0]);
+  if (nb_threads() > 1) {
+    sim_parallel(inst, n, m, &cumP0[0], NULL, y, S, CondVol);
+  } else {
+    sim_serial(inst, n, m, &cumP0[0], NULL, y, S, CondVol);
   }
   return (List::create(Rcpp::Named("draws") = y, Rcpp::Named("state") = S,  Rcpp::Named("CondVol") = CondVol));
 }
 
+// the 'm' paths are advanced together, one step at a time: the uniforms of
+// the states are drawn in one block per step, the innovations in one block
+// per regime and step, and the volatilities of all paths are stored by
+// regime ('vol[k * m + i]'), so that nothing is allocated for a single path
 inline List MSgarch::f_simAhead(const NumericVector& y, const int& n, const int& m,
                                 const NumericVector& theta,
                                 const NumericVector& P0_) {
   // setup
-  K = get_K();
   int nb_obs = y.size();  // total number of observations to simulate
+  MSgarchInstance inst(*this, theta);  // load parameters
+  volatilityVector vol0 = inst.set_vol(y[0]);
+  for (int t = 1; t <= nb_obs; t++) {
+    inst.increment_vol(vol0, y[t - 1]);  // increment all volatilities
+  }
+  return sim_ahead(inst, vol0, P0_.begin(), n, m);
+}
+
+// same, starting from the volatilities and one-step-ahead probabilities of
+// the vector of parameters 'j' of a filter state (see 'f_filter_init')
+inline List MSgarch::f_simAhead_filter(const List& state, const int& j,
+                                       const int& n, const int& m,
+                                       const NumericVector& theta) {
+  NumericMatrix h = state["h"], lnh = state["lnh"], fh = state["fh"];
+  NumericMatrix PredProb = state["PredProb"];
+  if ((j < 0) || (j >= h.nrow()) || (h.ncol() != K))
+    stop("the filter state does not match the parameters");
+  MSgarchInstance inst(*this, theta);  // load parameters
+  volatilityVector vol0(K);
+  std::vector<double> P0(K);
+  for (int k = 0; k < K; k++) {
+    vol0[k].h = h(j, k), vol0[k].lnh = lnh(j, k), vol0[k].fh = fh(j, k);
+    P0[k] = PredProb(j, k);
+  }
+  return sim_ahead(inst, vol0, &P0[0], n, m);
+}
+
+inline List MSgarch::sim_ahead(const MSgarchInstance& inst,
+                               const volatilityVector& vol0, const double* P0_,
+                               const int& n, const int& m) const {
   NumericMatrix y_sim(m, n);
   NumericMatrix S(m, n);
   arma::cube CondVol(m,n,K);
-  loadparam(theta);  // load parameters
-  prep_ineq_vol();   // prep for 'set_vol'
-  volatilityVector vol0 = set_vol(y[0]);
-  double z;
-  for (int t = 1; t <= nb_obs; t++) {
-    increment_vol(vol0, y[t - 1]);  // increment all volatilities
+  volatilityVector vol(K * m);
+  for (int k = 0; k < K; k++)
+    std::fill(vol.begin() + k * m, vol.begin() + (k + 1) * m, vol0[k]);
+
+  // cumulative probabilities of the initial state
+  std::vector<double> cumP0(K);
+  cumulate_rows(P0_, 1, K, &cumP0[0]);
+  if (sim_method() > 0) {  // variance reduction
+    std::vector<double> u = sim_uniforms(sim_method(), m, 2 * n);
+    sim_parallel(inst, n, m, &cumP0[0], &vol0, y_sim, S, CondVol, &u[0]);
+    return (List::create(Rcpp::Named("draws") = y_sim, Rcpp::Named("state") = S,  Rcpp::Named("CondVol") = CondVol));
   }
-  for (int i = 0; i < m; i++) {
-    S(i,0) = sampleState(P0_);           // sample initial state
-    z = rndgen(S(i,0));
-    y_sim(i,0) = z * sqrt(vol0[S(i,0)].h);  // first draw
+  if (nb_threads() > 1) {
+    sim_parallel(inst, n, m, &cumP0[0], &vol0, y_sim, S, CondVol);
+    return (List::create(Rcpp::Named("draws") = y_sim, Rcpp::Named("state") = S,  Rcpp::Named("CondVol") = CondVol));
   }
-  volatilityVector vol = vol0;
-  for (int i = 0; i < m; i++) {
-    for (int s = 0; s < K; s++) {
-      CondVol(i, 0, s) = sqrt(vol[s].h);
+
+  // the innovations are drawn as in 'sim_path', from R's RNG
+  RRng gen;
+  int method = rnd_method();
+  for (int k = 0; k < K; k++) inst.models[k]->spec_prep_rnd();
+  std::vector<int> state(m), count(K), start(K), path(m);
+  std::vector<double> u(m), z(m);
+  for (int t = 0; t < n; t++) {
+    // sample the states
+    for (int i = 0; i < m; i++) u[i] = gen.unif();
+    std::fill(count.begin(), count.end(), 0);
+    for (int i = 0; i < m; i++) {
+      int s = ((t == 0) ? sampleCum(&cumP0[0], K, u[i])
+                        : inst.sample_next(state[i], u[i]));
+      state[i] = s;
+      count[s]++;
+      S(i, t) = s;
     }
-    for (int t = 1; t < n; t++) {
-      S(i,t) = sampleState(P(S(i,t - 1), _));  // sample new state
-      z = rndgen(S(i,t));                    // sample new innovation
-      increment_vol(vol, y_sim(i,t - 1));    // increment all volatilities
-      y_sim(i,t) = z * sqrt(vol[S(i,t)].h);
-      for (int s = 0; s < K; s++) {
-        CondVol(i, t, s) = sqrt(vol[s].h);
-      }
-    }  // new draw
-    vol = vol0;
+    // sample the innovations of the paths in each state
+    for (int k = 1; k < K; k++) start[k] = start[k - 1] + count[k - 1];
+    for (int i = 0; i < m; i++) path[start[state[i]]++] = i;
+    for (int k = 0, pos = 0; k < K; k++) {
+      if (count[k] == 0) continue;
+      for (int r = 0; r < count[k]; r++, pos++)
+        z[path[pos]] = inst.models[k]->spec_draw(gen, method);
+    }
+    std::fill(start.begin(), start.end(), 0);
+    // increment the volatilities and draw
+    for (int k = 0; k < K; k++) {
+      volatility* vol_k = &vol[k * m];
+      if (t > 0)
+        for (int i = 0; i < m; i++)
+          inst.models[k]->spec_increment_vol(vol_k[i], y_sim(i, t - 1));
+      for (int i = 0; i < m; i++) CondVol(i, t, k) = sqrt(vol_k[i].h);
+    }
+    for (int i = 0; i < m; i++)
+      y_sim(i, t) = z[i] * CondVol(i, t, state[i]);  // new draw
   }
   return (List::create(Rcpp::Named("draws") = y_sim, Rcpp::Named("state") = S,  Rcpp::Named("CondVol") = CondVol));
 }
 
 inline List MSgarch::f_rnd(const int& n, const NumericVector& theta,
                            const NumericVector& y) {
-  // setup
+  MSgarchInstance inst(*this, theta);  // load parameters
+  volatilityVector vol;
+  NumericVector Ppred(K);
+  inst.filter(y, vol, Ppred.begin());  // one-step-ahead volatilities and probabilities
+  NumericMatrix draws(n, 1), states(n, 1);
+  arma::cube CondVol(n, 1, K);
+  std::vector<double> cumP(K);
+  cumulate_rows(Ppred.begin(), 1, K, &cumP[0]);
+  if (nb_threads() > 1) {
+    sim_parallel(inst, 1, n, &cumP[0], &vol, draws, states, CondVol);
+  } else {
+    sim_serial(inst, 1, n, &cumP[0], &vol, draws, states, CondVol);
+  }
+  return (Rcpp::List::create(
+      Rcpp::Named("draws") = NumericVector(draws.begin(), draws.end()),
+      Rcpp::Named("state") = NumericVector(states.begin(), states.end())));
+}
+
+//-------------------------------------  Hamilton filter
+//-------------------------------------//
+// increments the volatilities, computes the kernels and advances the filter
+// in a single pass over the data, by blocks of KERNEL_BLOCK_SIZE
+// observations (the K x (T-1) matrix of kernels is never stored) on the
+// models of the instance 'inst'; returns the loglikelihood and leaves in
+// 'vol' the one-step-ahead volatilities (see 'MSgarchInstance::filter' for
+// the filter state)
+inline double MSgarch::HamiltonFilter(const MSgarchInstance& inst,
+                                      const NumericVector& y,
+                                      volatilityVector& vol) const {
   int nb_obs = y.size();
-  NumericVector draw(n);  // draw
-  IntegerVector S(n);     // states of the Markov chain
-  loadparam(theta);       // load parameters
-  double z;
-  prep_ineq_vol();  // prep for 'set_vol'
-  volatilityVector vol = set_vol(y[0]);
+  double lnd = 0;
+  std::vector<double> Pspot(inst.P0);  // Prob(St | I(t))
+  std::vector<double> Ppred(K), work(2 * K + 1);
+  std::vector<double> lndBlock(K * KERNEL_BLOCK_SIZE);  // kernels of a block
+  double h[KERNEL_BLOCK_SIZE], lnh[KERNEL_BLOCK_SIZE];
   
-  for (int i = 1; i <= nb_obs; i++) {  // loop over observations
-    increment_vol(vol, y[i - 1]);      // increment all volatilities
-  }
-  HamiltonFilter(calc_lndMat(y));
+  // initialize
+  vol = inst.set_vol(y[0]);
   
-  // increment over time
-  for (int i = 0; i < n; i++) {
-    S[i] = sampleState(PLast);        // sample new state
-    z = rndgen(S[i]);                 // sample new innovation
-    draw[i] = z * sqrt(vol[S[i]].h);  // new draw
+  // loop over blocks of observations
+  for (int first = 1; first < nb_obs; first += KERNEL_BLOCK_SIZE) {
+    int n = std::min(KERNEL_BLOCK_SIZE, nb_obs - first);
+    for (int k = 0; k < K; k++) {
+      for (int i = 0; i < n; i++) {
+        inst.models[k]->spec_increment_h(vol[k], y[first + i - 1]);
+        h[i] = vol[k].h, lnh[i] = vol[k].lnh;
+      }
+      inst.models[k]->spec_set_lnh_block(h, lnh, n);
+      inst.models[k]->spec_calc_kernel_block(h, lnh, &y[first],
+                                             &lndBlock[k * KERNEL_BLOCK_SIZE], n);
+      vol[k].lnh = lnh[n - 1];
+    }
+    for (int i = 0; i < n; i++)
+      lnd += filter_step(&inst.P_row[0], &Pspot[0], &Ppred[0], &lndBlock[i],
+                         KERNEL_BLOCK_SIZE, &work[0]);  // increment loglikelihood
   }
-  NumericVector yy(draw.begin(), draw.end());
-  NumericVector SS(S.begin(), S.end());
-  return (
-      Rcpp::List::create(Rcpp::Named("draws") = yy, Rcpp::Named("state") = SS));
+  if (nb_obs > 0) inst.increment_vol(vol, y[nb_obs - 1]);
+  return lnd;
 }
 
-//------------------------------ Compute loglikelihood matrix
-//------------------------------//
-inline NumericMatrix MSgarch::calc_lndMat(const NumericVector& y) {
-  // set up
-  int nb_obs = y.size();
-  NumericMatrix lndMat(K, nb_obs - 1);
+// kernels 'lnd[t * K + k]' of the observations 'y[t + 1]', 't' in
+// [0, T - 2], for the models of the instance 'inst': the volatility
+// recursion of each model runs along the data on a thread of its own (by
+// blocks of KERNEL_BLOCK_SIZE observations, as in 'HamiltonFilter'), then the
+// kernels of blocks of observations are computed in parallel on copies of
+// the models. Keeps the variances and their logarithms of the whole series
+// (2 K (T - 1) doubles)
+inline void MSgarch::calc_lnd_mat(const MSgarchInstance& inst,
+                                  const NumericVector& y, double* lnd) const {
+  int n_step = y.size() - 1;
+  if (n_step <= 0) return;
+  int nb_thread = std::max(1, nb_threads());
+  std::vector<double> h((size_t)K * n_step), lnh((size_t)K * n_step);
+  volatilityVector vol0 = inst.set_vol(y[0]);  // calls the R API
   
-  // initialize
-  volatilityVector vol = set_vol(y[0]);
-  prep_kernel();
+  // volatilities of each model
+#pragma omp parallel for schedule(static) num_threads(std::min(K, nb_thread))
+  for (int k = 0; k < K; k++) {
+    volatility vol = vol0[k];
+    double* h_k = &h[(size_t)k * n_step];
+    double* lnh_k = &lnh[(size_t)k * n_step];
+    for (int first = 0; first < n_step; first += KERNEL_BLOCK_SIZE) {
+      int n = std::min(KERNEL_BLOCK_SIZE, n_step - first);
+      for (int i = 0; i < n; i++) {
+        inst.models[k]->spec_increment_h(vol, y[first + i]);
+        h_k[first + i] = vol.h, lnh_k[first + i] = vol.lnh;
+      }
+      inst.models[k]->spec_set_lnh_block(&h_k[first], &lnh_k[first], n);
+      vol.lnh = lnh_k[first + n - 1];
+    }
+  }
   
-  // loop over observations
-  for (int t = 1; t < nb_obs; t++) {
-    increment_vol(vol, y[t - 1]);               // increment all volatilities
-    lndMat(_, t - 1) = calc_kernel(vol, y[t]);  // calc all kernels
+  // kernels, by blocks of observations
+  int nb_blocks = (n_step + KERNEL_BLOCK_SIZE - 1) / KERNEL_BLOCK_SIZE;
+  many local(K * nb_thread);  // 'local[i * K + k]' for thread i
+  for (int i = 0; i < nb_thread; i++)
+    for (int k = 0; k < K; k++) local[i * K + k] = inst.models[k]->clone();
+#pragma omp parallel for schedule(static) num_threads(nb_thread)
+  for (int b = 0; b < nb_blocks; b++) {
+    Base* const* mod = &local[thread_id() * K];
+    double out[KERNEL_BLOCK_SIZE];
+    int first = b * KERNEL_BLOCK_SIZE;
+    int n = std::min(KERNEL_BLOCK_SIZE, n_step - first);
+    for (int k = 0; k < K; k++) {
+      size_t ind = (size_t)k * n_step + first;
+      mod[k]->spec_calc_kernel_block(&h[ind], &lnh[ind], &y[first + 1], out, n);
+      for (int i = 0; i < n; i++) lnd[(size_t)(first + i) * K + k] = out[i];
+    }
   }
-  return lndMat;
+  for (many::iterator it = local.begin(); it != local.end(); ++it) delete *it;
 }
 
-//-------------------------------------  Hamilton filter
+// loglikelihood of the models of the instance 'inst' over 'y', from the
+// kernels of 'calc_lnd_mat' filtered by 'HamiltonScan' in chunks of at
+// least MSGARCH_SCAN_MIN observations (see 'filter_scan'); costs K (T - 1)
+// doubles for the kernels on top of those of 'calc_lnd_mat'
+inline double MSgarch::HamiltonFilterScan(const MSgarchInstance& inst,
+                                          const NumericVector& y) const {
+  int n_step = y.size() - 1;
+  if (n_step <= 0) return 0;
+  std::vector<double> lnd((size_t)K * n_step);
+  calc_lnd_mat(inst, y, &lnd[0]);
+  int nb_chunk =
+      std::max(1, std::min(nb_threads(), n_step / MSGARCH_SCAN_MIN));
+  return HamiltonScan(K, &inst.P_row[0], &inst.P0[0], &lnd[0], n_step,
+                      nb_chunk, NULL, NULL);
+}
+
+//------------------------------------- Filter state
 //-------------------------------------//
-inline double MSgarch::HamiltonFilter(const NumericMatrix& lndMat) {
-  int n_step = lndMat.ncol();
-  double lnd = 0, min_lnd, delta, sum_tmp;
-  NumericVector Pspot, Ppred, lndCol, tmp;
-  
-  // first step
-  Pspot = clone(P0);             // Prob(St | I(t)
-  Ppred = matrixProd(Pspot, P);  // one-step-ahead Prob(St | I(t-1))
-  lndCol = lndMat(_, 0);
-  min_lnd = min(lndCol),
-    delta =
-      ((min_lnd < LND_MIN) ? LND_MIN - min_lnd : 0);  // handle over/under-flows
-  tmp = Ppred *
-    exp(lndCol + delta);  // unormalized one-step-ahead Prob(St | I(t))
-  
-  // remaining steps
-  for (int t = 1; t < n_step; t++) {
-    sum_tmp = sum(tmp);
-    lnd += -delta + log(sum_tmp);  // increment loglikelihood
-    Pspot = tmp / sum_tmp;
-    Ppred = matrixProd(Pspot, P);
-    lndCol = lndMat(_, t);
-    min_lnd = min(lndCol),
-      delta = ((min_lnd < LND_MIN) ? LND_MIN - min_lnd
-                 : 0);  // handle over/under-flows
-    tmp = Ppred * exp(lndCol + delta);
-  }
-  sum_tmp = sum(tmp);
-  lnd += -delta + log(sum_tmp);  // increment loglikelihood
-  Pspot = tmp / sum_tmp;
-  PLast = matrixProd(Pspot, P);
-  return lnd;
+inline void MSgarch::filter_store(const int& j, const MSgarchInstance& inst,
+                                  const volatilityVector& vol,
+                                  const double* Pspot, NumericMatrix& h,
+                                  NumericMatrix& lnh, NumericMatrix& fh,
+                                  NumericMatrix& P_spot,
+                                  NumericMatrix& PredProb) const {
+  std::vector<double> Ppred(K);
+  inst.predict(Pspot, &Ppred[0]);
+  for (int k = 0; k < K; k++) {
+    h(j, k) = vol[k].h, lnh(j, k) = vol[k].lnh, fh(j, k) = vol[k].fh;
+    P_spot(j, k) = Pspot[k];
+    PredProb(j, k) = Ppred[k];
+  }
+}
+
+// the state holds, for each vector of parameters, the one-step-ahead
+// volatilities ('h', 'lnh' and 'fh') of all models, the filtered and
+// one-step-ahead probabilities ('Pspot' and 'PredProb') and the
+// loglikelihood 'LL', as computed by 'HamiltonFilter'
+inline List MSgarch::f_filter_init(NumericMatrix& all_thetas,
+                                   const NumericVector& y) {
+  int nb_obs = y.size();
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix h(nb_thetas, K), lnh(nb_thetas, K), fh(nb_thetas, K);
+  NumericMatrix P_spot(nb_thetas, K), PredProb(nb_thetas, K);
+  NumericVector LL(nb_thetas), theta_j;
+  std::vector<double> Pspot(K);
+  if (nb_obs == 0) stop("y is empty");
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    MSgarchInstance inst(*this, theta_j);
+    volatilityVector vol = inst.set_vol(y[0]);
+    inst.increment_vol(vol, y[0]);
+    Pspot = inst.P0;
+    LL[j] = inst.advance(vol, &Pspot[0], y.begin() + 1, nb_obs - 1);
+    filter_store(j, inst, vol, &Pspot[0], h, lnh, fh, P_spot, PredProb);
+  }
+  return List::create(Rcpp::Named("h") = h, Rcpp::Named("lnh") = lnh,
+                      Rcpp::Named("fh") = fh, Rcpp::Named("Pspot") = P_spot,
+                      Rcpp::Named("PredProb") = PredProb,
+                      Rcpp::Named("LL") = LL);
+}
+
+// O(K^2) per observation and vector of parameters: the filter is advanced
+// from the stored state, not from the start of the data
+inline List MSgarch::f_filter_update(NumericMatrix& all_thetas,
+                                     const List& state,
+                                     const NumericVector& y) {
+  int nb_obs = y.size();
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix h = Rcpp::clone(as<NumericMatrix>(state["h"]));
+  NumericMatrix lnh = Rcpp::clone(as<NumericMatrix>(state["lnh"]));
+  NumericMatrix fh = Rcpp::clone(as<NumericMatrix>(state["fh"]));
+  NumericMatrix P_spot = Rcpp::clone(as<NumericMatrix>(state["Pspot"]));
+  NumericMatrix PredProb(nb_thetas, K);
+  NumericVector LL = Rcpp::clone(as<NumericVector>(state["LL"]));
+  NumericVector theta_j;
+  volatilityVector vol(K);
+  std::vector<double> Pspot(K);
+  if ((h.nrow() != nb_thetas) || (h.ncol() != K) || (LL.size() != nb_thetas))
+    stop("the filter state does not match the parameters");
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    MSgarchInstance inst(*this, theta_j);
+    for (int k = 0; k < K; k++) {
+      vol[k].h = h(j, k), vol[k].lnh = lnh(j, k), vol[k].fh = fh(j, k);
+      Pspot[k] = P_spot(j, k);
+    }
+    LL[j] += inst.advance(vol, &Pspot[0], y.begin(), nb_obs);
+    filter_store(j, inst, vol, &Pspot[0], h, lnh, fh, P_spot, PredProb);
+  }
+  return List::create(Rcpp::Named("h") = h, Rcpp::Named("lnh") = lnh,
+                      Rcpp::Named("fh") = fh, Rcpp::Named("Pspot") = P_spot,
+                      Rcpp::Named("PredProb") = PredProb,
+                      Rcpp::Named("LL") = LL);
+}
+
+//------------------------------------- Variance forecasts
+//-------------------------------------//
+// expected variance of the observations 1 to 'n_ahead' steps after 'y' (one
+// column per vector of parameters), exact when all the models have a
+// closed form (see 'forecast_coeffs') and NA otherwise. With
+// 'A_t(k, j) := E[h_{k,t} I(S_t = j)]', the variance at 't' is the sum of
+// 'A_t(j, j)' over 'j', and since the volatility of model 'k' is driven by
+// 'y_t = z_t sqrt(h_{S_t,t})' whatever the regime:
+// 'E[h_{k,t+1} I(S_t = j)] = c_k[0] Prob(S_t = j) + (c_k[1] + c_k[2]
+// c_j[4]) A_t(j, j) + c_k[3] A_t(k, j)', then 'A_{t+1} = E[h_{t+1} I(S_t)] P'
+inline NumericMatrix MSgarch::f_forecast_var(NumericMatrix& all_thetas,
+                                             const NumericVector& y,
+                                             const int& n_ahead) {
+  return f_forecast_var_filter(all_thetas, f_filter_init(all_thetas, y),
+                               n_ahead);
+}
+
+inline NumericMatrix MSgarch::f_forecast_var_filter(NumericMatrix& all_thetas,
+                                                    const List& state,
+                                                    const int& n_ahead) {
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix out(n_ahead, nb_thetas);
+  NumericMatrix h = state["h"], PredProb = state["PredProb"];
+  NumericVector theta_j;
+  if ((h.nrow() != nb_thetas) || (h.ncol() != K))
+    stop("the filter state does not match the parameters");
+  std::vector<double> c(5 * K), A(K * K), B(K * K), prob(K), tmp(K);
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    MSgarchInstance inst(*this, theta_j);
+    for (int k = 0; k < K; k++) {
+      if (!inst.models[k]->spec_forecast_coeffs(&c[5 * k])) {
+        std::fill(out.begin(), out.end(), NA_REAL);
+        return out;
+      }
+    }
+    for (int k = 0; k < K; k++) {  // step 1: known volatilities
+      prob[k] = PredProb(j, k);
+      for (int s = 0; s < K; s++) A[k * K + s] = h(j, k) * PredProb(j, s);
+    }
+    for (int t = 0; t < n_ahead; t++) {
+      if (t > 0) {
+        for (int k = 0; k < K; k++) {
+          const double* ck = &c[5 * k];
+          for (int s = 0; s < K; s++)
+            B[k * K + s] = ck[0] * prob[s] +
+                           (ck[1] + ck[2] * c[5 * s + 4]) * A[s * K + s] +
+                           ck[3] * A[k * K + s];
+        }
+        for (int k = 0; k < K; k++) {
+          for (int l = 0; l < K; l++) {
+            A[k * K + l] = 0;
+            for (int s = 0; s < K; s++)
+              A[k * K + l] += B[k * K + s] * inst.P_row[s * K + l];
+          }
+        }
+        for (int l = 0; l < K; l++) {
+          tmp[l] = 0;
+          for (int s = 0; s < K; s++) tmp[l] += prob[s] * inst.P_row[s * K + l];
+        }
+        prob = tmp;
+      }
+      out(t, j) = 0;
+      for (int k = 0; k < K; k++) out(t, j) += A[k * K + k];
+    }
+  }
+  return out;
+}
+
+//------------------------------------- Predictive distribution
+//-------------------------------------//
+// same as 'SingleRegime::f_pred_filter', the regimes being weighted by the
+// one-step-ahead probabilities 'PredProb' of the filter state
+inline NumericVector MSgarch::f_pred_filter(const NumericVector& x,
+                                            NumericMatrix& all_thetas,
+                                            const List& state,
+                                            const bool& do_cdf) {
+  int nx = x.size();
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix h = state["h"], PredProb = state["PredProb"];
+  if ((h.nrow() != nb_thetas) || (h.ncol() != K))
+    stop("the filter state does not match the parameters");
+  NumericVector out(nx);
+  NumericVector theta_j;
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    MSgarchInstance inst(*this, theta_j);
+    for (int k = 0; k < K; k++) {
+      double sig = sqrt(h(j, k)), w = PredProb(j, k) / nb_thetas;
+      Base* mod = inst.models[k];
+      for (int i = 0; i < nx; i++)
+        out[i] += w * ((do_cdf) ? mod->spec_calc_cdf(x[i] / sig)
+                                : mod->spec_calc_pdf(x[i] / sig) / sig);
+    }
+  }
+  return out;
+}
+
+//------------------------------------- Risk measures
+//-------------------------------------//
+// same as 'SingleRegime::f_risk', the components of the mixture being the
+// models of all the regimes weighted by their one-step-ahead probabilities
+// (those of 'f_get_Pstate', starting from 'P0' at the first observation):
+// the Hamilton filters of all the vectors of parameters are advanced
+// together over the data, each on its own instance of the models
+inline List MSgarch::f_risk(NumericMatrix& all_thetas, const NumericVector& y,
+                            const NumericVector& alpha, const bool& do_its,
+                            const bool& do_es) {
+  int nb_obs = y.size();
+  int nb_thetas = all_thetas.nrow();
+  int nb_comp = nb_thetas * K;
+  if (nb_obs == 0) stop("y is empty");
+  std::vector<MSgarchInstance*> inst(nb_thetas);
+  volatilityVector vol(nb_comp);
+  std::vector<double> Pspot(nb_comp), Ppred(nb_comp), lndCol(K);
+  std::vector<double> work(2 * K + 1);
+  NumericVector theta_j;
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    inst[j] = new MSgarchInstance(*this, theta_j);
+    volatilityVector vol_j = inst[j]->set_vol(y[0]);
+    for (int k = 0; k < K; k++) {
+      vol[j * K + k] = vol_j[k];
+      Pspot[j * K + k] = Ppred[j * K + k] = inst[j]->P0[k];
+    }
+  }
+  NumericMatrix VaR((do_its) ? nb_obs : 1, alpha.size());
+  NumericMatrix ES((do_its) ? nb_obs : 1, alpha.size());
+  if (!do_es) std::fill(ES.begin(), ES.end(), NA_REAL);
+  int nb_na = 0;
+  for (int i = 0; i <= nb_obs; i++) {  // 'nb_obs': one step after the data
+    for (int j = 0; (i > 0) && (j < nb_thetas); j++) {
+      Base* const* mod = &inst[j]->models[0];
+      for (int k = 0; k < K; k++)
+        mod[k]->spec_increment_vol(vol[j * K + k], y[i - 1]);
+      if (i < nb_obs) {  // Prob(S_i | I(i-1))
+        for (int k = 0; k < K; k++)
+          lndCol[k] = mod[k]->spec_calc_kernel(vol[j * K + k], y[i]);
+        inst[j]->filter_step(&Pspot[j * K], &Ppred[j * K], &lndCol[0],
+                             &work[0]);
+      } else {  // Prob(S_{T+1} | I(T))
+        inst[j]->predict(&Pspot[j * K], &Ppred[j * K]);
+      }
+    }
+    if ((do_its) ? (i == nb_obs) : (i < nb_obs)) continue;
+    RiskMixture mix;
+    for (int c = 0; c < nb_comp; c++)
+      mix.add(inst[c / K]->models[c % K], Ppred[c] / nb_thetas,
+              sqrt(vol[c].h));
+    nb_na += mix.risk(alpha, do_es, ((do_its) ? i : 0), VaR, ES);
+  }
+  for (int j = 0; j < nb_thetas; j++) delete inst[j];
+  risk_warning(nb_na);
+  return List::create(Rcpp::Named("VaR") = VaR, Rcpp::Named("ES") = ES);
+}
+
+// same as 'SingleRegime::f_risk_filter', the regimes being weighted by the
+// one-step-ahead probabilities 'PredProb' of the filter state
+inline List MSgarch::f_risk_filter(NumericMatrix& all_thetas,
+                                   const List& state,
+                                   const NumericVector& alpha,
+                                   const bool& do_es) {
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix h = state["h"], PredProb = state["PredProb"];
+  if ((h.nrow() != nb_thetas) || (h.ncol() != K))
+    stop("the filter state does not match the parameters");
+  std::vector<MSgarchInstance*> inst(nb_thetas);
+  RiskMixture mix;
+  NumericVector theta_j;
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    inst[j] = new MSgarchInstance(*this, theta_j);
+    for (int k = 0; k < K; k++)
+      mix.add(inst[j]->models[k], PredProb(j, k) / nb_thetas, sqrt(h(j, k)));
+  }
+  NumericMatrix VaR(1, alpha.size()), ES(1, alpha.size());
+  if (!do_es) std::fill(ES.begin(), ES.end(), NA_REAL);
+  int nb_na = mix.risk(alpha, do_es, 0, VaR, ES);
+  for (int j = 0; j < nb_thetas; j++) delete inst[j];
+  risk_warning(nb_na);
+  return List::create(Rcpp::Named("VaR") = VaR, Rcpp::Named("ES") = ES);
 }
 
 inline List MSgarch::f_get_Pstate(const NumericVector& theta,
                                   const NumericVector& y) {
   // init
-  loadparam(theta);  // load parameters
-  prep_ineq_vol();   // prepare functions related to volatility
-  volatilityVector vol = set_vol(y[0]);   // initialize volatility
-  NumericMatrix lndMat = calc_lndMat(y);  // likelihood in each state
-  
-  int n_step = lndMat.ncol();
-  double lnd = 0, min_lnd, delta, sum_tmp;
-  NumericVector Pspot, Ppred, lndCol, tmp;
+  MSgarchInstance inst(*this, theta);  // load parameters
+  int n_step = y.size() - 1;
+  NumericMatrix lndMat(K, n_step);  // likelihood in each state
+  calc_lnd_mat(inst, y, lndMat.begin());
+  
+  // filter, split into chunks of at least MSGARCH_SCAN_MIN observations
+  // filtered in parallel (see 'HamiltonScan') if 'filter_scan' is set,
+  // sequential otherwise
+  int nb_chunk = ((filter_scan() == 1)
+      ? std::max(1, std::min(nb_threads(), n_step / MSGARCH_SCAN_MIN)) : 1);
+  std::vector<double> Pspot((size_t)n_step * K);  // Prob(St | I(t))
+  std::vector<double> Ppred((size_t)n_step * K);  // Prob(St | I(t-1))
+  double lnd = HamiltonScan(K, &inst.P_row[0], &inst.P0[0], lndMat.begin(),
+                            n_step, nb_chunk, &Pspot[0], &Ppred[0]);
   arma::mat PtmpSpot(n_step + 1, K);
   arma::mat PtmpPred(n_step + 2, K);
   arma::mat PtmpSmooth(n_step + 2, K);
   
-  // first step
-  Pspot = clone(P0);             // Prob(St | I(t))
-  Ppred = matrixProd(Pspot, P);  // one-step-ahead Prob(St | I(t-1))
   for (int i = 0; i < K; i++) {
-    PtmpSpot(0, i) = Pspot(i);
+    PtmpSpot(0, i) = inst.P0[i];
+    PtmpPred(0, i) = inst.P0[i];
   }
-  
-  for (int i = 0; i < K; i++) {
-    PtmpPred(0, i) = Pspot(i);
-  }
-  for (int i = 0; i < K; i++) {
-    PtmpPred(1, i) = Ppred(i);
-  }
-  lndCol = lndMat(_, 0);
-  min_lnd = min(lndCol),
-    delta =
-      ((min_lnd < LND_MIN) ? LND_MIN - min_lnd : 0);  // handle over/under-flows
-  tmp = Ppred *
-    exp(lndCol + delta);  // unormalized one-step-ahead Prob(St | I(t))
-  
-  // remaining steps
-  for (int t = 1; t < n_step; t++) {
-    sum_tmp = sum(tmp);
-    lnd += -delta + log(sum_tmp);  // increment loglikelihood
-    Pspot = tmp / sum_tmp;
-    Ppred = matrixProd(Pspot, P);
-    for (int i = 0; i < K; i++) {
-      PtmpSpot(t, i) = Pspot(i);
-    }
+  for (int t = 0; t < n_step; t++) {
     for (int i = 0; i < K; i++) {
-      PtmpPred(t + 1, i) = Ppred(i);
+      PtmpPred(t + 1, i) = Ppred[(size_t)t * K + i];
+      PtmpSpot(t + 1, i) = Pspot[(size_t)t * K + i];
     }
-    lndCol = lndMat(_, t);
-    min_lnd = min(lndCol),
-      delta = ((min_lnd < LND_MIN) ? LND_MIN - min_lnd
-                 : 0);  // handle over/under-flows
-    tmp = Ppred * exp(lndCol + delta);
   }
-  sum_tmp = sum(tmp);
-  lnd += -delta + log(sum_tmp);  // increment loglikelihood
-  Pspot = tmp / sum_tmp;
-  PLast = matrixProd(Pspot, P);
+  std::vector<double> P_end(K), P_last(K);
+  for (int i = 0; i < K; i++) P_end[i] = PtmpSpot(n_step, i);
+  inst.predict(&P_end[0], &P_last[0]);
   
   for (int i = 0; i < K; i++) {
-    PtmpSpot(n_step, i) = Pspot(i);
+    PtmpPred(n_step + 1, i) = P_last[i];
   }
   for (int i = 0; i < K; i++) {
-    PtmpPred(n_step + 1, i) = PLast(i);
-  }
-  for (int i = 0; i < K; i++) {
-    PtmpSmooth(n_step + 1, i) = PLast(i);
+    PtmpSmooth(n_step + 1, i) = P_last[i];
   }
   arma::mat tmpMat(1, 2);
   arma::mat tmpMat2(2, 1);
+  arma::mat P_arma(K, K);
+  for (int i = 0; i < K; i++)
+    for (int l = 0; l < K; l++) P_arma(i, l) = inst.P_row[i * K + l];
   for (int t = n_step; t >= 0; t--) {
     tmpMat = (PtmpSmooth.row(t + 1) / PtmpPred.row(t + 1));
-    tmpMat2 = (as<arma::mat>(P) * tmpMat.t());
+    tmpMat2 = (P_arma * tmpMat.t());
     PtmpSmooth.row(t) = PtmpSpot.row(t) % tmpMat2.t();
   }
   
   return List::create(
     Rcpp::Named("FiltProb") = PtmpSpot, Rcpp::Named("PredProb") = PtmpPred,
-    Rcpp::Named("SmoothProb") = PtmpSmooth, Rcpp::Named("LL") = lndMat);
+    Rcpp::Named("SmoothProb") = PtmpSmooth, Rcpp::Named("LL") = lndMat,
+    Rcpp::Named("lnd") = lnd);
 }
 
 //------------------------------------- Model evaluation
@@ -763,25 +1510,303 @@ inline NumericVector MSgarch::eval_model(NumericMatrix& all_thetas,
   int nb_thetas = all_thetas.nrow();
   NumericVector lnd(nb_thetas), theta_j(all_thetas.ncol());
   prior pr;
-  double tmp;
+  
+  // each vector of parameters is loaded into an instance of its own (see
+  // 'MSgarchInstance') here, by rounds of 'nb_round' rows with a non-null
+  // prior whose loglikelihoods are then computed in parallel, by blocks of
+  // 'nb_block' rows sharing one pass over the data (or one row at a time,
+  // parallel in time, see 'filter_scan')
+  int nb_thread = std::max(1, nb_threads());
+  int nb_block = std::max(1, std::min(MSGARCH_BATCH_SIZE,
+                                      (nb_thetas + nb_thread - 1) / nb_thread));
+  int nb_round = nb_block * nb_thread;
+  int nb_obs = y.size();
+  const double* y_ptr = y.begin();
+  std::vector<MSgarchInstance*> inst(nb_round);
+  std::vector<int> rows(nb_round);
+  std::vector<double> lnd_rows(nb_round);
+  std::vector<double> P_all(nb_round * K * K);  // their transition-probability
+  std::vector<double> P0_all(nb_round * K);     // matrices and initial
+                                                // distributions
+  many batch(K * nb_round);  // 'batch[(i * K + k) * nb_block + b]' for block i
+  int n = 0;
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    MSgarchInstance* inst_j = new MSgarchInstance(*this, theta_j);
+    pr = calc_prior(*inst_j, theta_j);
+    if (do_prior == true) {
+      lnd[j] = pr.r2 + pr.r3;
+    } else {
+      lnd[j] = pr.r2;
+    }
+    if (pr.r1 && (filter_scan() == 1)) {  // parallel in time
+      lnd[j] += HamiltonFilterScan(*inst_j, y);
+      delete inst_j;
+    } else if (pr.r1) {  // if prior satisfied
+      int i = n / nb_block, b = n % nb_block;
+      for (int k = 0; k < K; k++)
+        batch[(i * K + k) * nb_block + b] = inst_j->models[k];
+      std::copy(inst_j->P_row.begin(), inst_j->P_row.end(), &P_all[n * K * K]);
+      std::copy(inst_j->P0.begin(), inst_j->P0.end(), &P0_all[n * K]);
+      inst[n] = inst_j;
+      rows[n] = j;
+      lnd_rows[n] = 0;
+      n++;
+    } else {
+      delete inst_j;
+    }
+    if ((n == nb_round) || ((j == nb_thetas - 1) && (n > 0))) {
+      int nb_blocks = (n + nb_block - 1) / nb_block;
+#pragma omp parallel for schedule(dynamic) num_threads(nb_thread)
+      for (int i = 0; i < nb_blocks; i++) {
+        int first = i * nb_block;
+        filter_batch(y_ptr, nb_obs, std::min(nb_block, n - first),
+                     &P_all[first * K * K], &P0_all[first * K],
+                     &batch[i * K * nb_block], nb_block, &lnd_rows[first]);
+      }
+      for (int r = 0; r < n; r++) {
+        lnd[rows[r]] += lnd_rows[r];
+        delete inst[r];
+      }
+      n = 0;
+    }
+  }
+  return lnd;
+}
+
+inline double MSgarch::eval_theta(const NumericVector& theta,
+                                  const NumericVector& y,
+                                  const bool& do_prior) {
+  MSgarchInstance inst(*this, theta);  // load parameters
+  prior pr = calc_prior(inst, theta);
+  double lnd = ((do_prior == true) ? pr.r2 + pr.r3 : pr.r2);
+  if (!pr.r1) return lnd;
+  if (filter_scan() == 1) return lnd + HamiltonFilterScan(inst, y);
+  volatilityVector vol;
+  return lnd + HamiltonFilter(inst, y, vol);
+}
+
+//------------------------------------- Model gradient
+//-------------------------------------//
+// loglikelihood (same as 'eval_model') and its gradient with respect to all
+// the parameters, the transition probabilities included; the derivatives in
+// the coefficients of the distributions are central differences (see
+// 'ModelGrad'). Rows outside the support of the prior get a null gradient
+inline List MSgarch::eval_model_grad(NumericMatrix& all_thetas,
+                                     const NumericVector& y,
+                                     const bool& do_prior) {
+  int nb_thetas = all_thetas.nrow();
+  int nb_coeffs = sum(NbParams);
+  int D = nb_coeffs + K * (K - 1);
+  NumericVector lnd(nb_thetas), theta_j(D);
+  NumericMatrix grad(nb_thetas, D);
+  std::vector<double> dlnd(D);
+  prior pr;
   
   // loop over each vector of parameters
   for (int j = 0; j < nb_thetas; j++) {
     theta_j = all_thetas(j, _);  // extract parameters
-    loadparam(theta_j);          // load parameters
-    prep_ineq_vol();
-    pr = calc_prior(theta_j);
+    MSgarchInstance inst(*this, theta_j);  // load parameters
+    pr = calc_prior(inst, theta_j);
     if (do_prior == true) {
       lnd[j] = pr.r2 + pr.r3;
     } else {
       lnd[j] = pr.r2;
     }
-    pr = calc_prior(theta_j);
-    tmp = 0;
-    if (pr.r1) tmp += HamiltonFilter(calc_lndMat(y));
-    lnd[j] += tmp;
+    if (!pr.r1) continue;
+    lnd[j] += calc_lnd_grad(inst, theta_j, y, &dlnd[0], NULL);
+    if (do_prior == true) {
+      for (int k = 0; k < K; k++)
+        inst.models[k]->spec_calc_prior_grad(extract_theta_it(theta_j, k),
+                                             &dlnd[MyCumsum(NbParams, k)]);
+    }
+    for (int d = 0; d < D; d++) grad(j, d) = dlnd[d];
+  }
+  return List::create(Rcpp::Named("lnd") = lnd, Rcpp::Named("grad") = grad);
+}
+
+// contributions of each observation to the gradient of the loglikelihood
+// (one row per observation but the first, which is not in the likelihood)
+inline NumericMatrix MSgarch::eval_model_score(const NumericVector& theta,
+                                               const NumericVector& y) {
+  int nb_obs = y.size();
+  int D = sum(NbParams) + K * (K - 1);
+  NumericMatrix score(std::max(nb_obs - 1, 0), D);
+  std::vector<double> dlnd(D);
+  MSgarchInstance inst(*this, theta);  // load parameters
+  calc_lnd_grad(inst, theta, y, &dlnd[0], score.begin());
+  return score;
+}
+
+// loglikelihood of the parameters 'theta' loaded in the instance 'inst' and
+// its gradient in 'dlnd':
+// the derivatives of the volatilities and kernels of each model are carried
+// through the Hamilton filter along the data (forward mode); those of the
+// initial distribution 'P0' follow from the linear system that defines it.
+// If 'score' is not null, the contribution of observation 't' to the
+// derivative 'd' is also stored in 'score[d * (nb_obs - 1) + t - 1]'
+inline double MSgarch::calc_lnd_grad(const MSgarchInstance& inst,
+                                     const NumericVector& theta,
+                                     const NumericVector& y, double* dlnd,
+                                     double* score) const {
+  // set up
+  int nb_obs = y.size();
+  int nb_coeffs = sum(NbParams);  // coefficients of the models
+  int nb_P = K * (K - 1);         // transition probabilities
+  int D = nb_coeffs + nb_P;
+  double lnd = 0;
+  NumericVector theta_it;
+  std::vector<int> first(K);  // first coefficient of each model
+  for (int k = 0; k < K; k++) first[k] = MyCumsum(NbParams, k);
+  std::vector<double> dh(nb_coeffs), dk(nb_coeffs), dS(D);
+  std::vector<double> Pspot(K), Ppred(K), lnd_k(K), f(K);
+  std::vector<double> dPspot(K * D), dPpred(K * D), df(K * D);  // 'k * D + d'
+  volatilityVector vol(K);
+  std::vector<BaseGrad*> grad(K);  // derivatives of the models
+  
+  // initialize volatilities, filter and derivatives
+  std::fill(dlnd, dlnd + D, 0.0);
+  for (int k = 0; k < K; k++) {
+    theta_it = extract_theta_it(theta, k);
+    grad[k] = inst.models[k]->spec_grad(theta_it);
+    vol[k] = grad[k]->set_vol_grad(y[0], &dh[first[k]]);
+    Pspot[k] = inst.P0[k];
+  }
+  if (nb_P > 0) {
+    // (I - P + U)' P0 = 1, so that (I - P + U)' dP0 = dP' P0
+    arma::mat I = arma::eye(K, K);
+    arma::mat Umat = arma::ones(K, K);
+    arma::mat P_arma = arma::mat(&inst.P_row[0], K, K).t();  // by rows
+    arma::mat Ainv = ((I - P_arma + Umat).t()).i();
+    arma::vec v(K);
+    for (int q = 0; q < nb_P; q++) {
+      int r = q / (K - 1), c = q % (K - 1);  // P(r, c), and P(r, K - 1)
+      v.zeros();
+      v(c) = inst.P0[r];
+      v(K - 1) = -inst.P0[r];
+      arma::vec dP0 = Ainv * v;
+      for (int k = 0; k < K; k++) dPspot[k * D + nb_coeffs + q] = dP0(k);
+    }
+  }
+  
+  // loop over observations
+  for (int t = 1; t < nb_obs; t++) {
+    for (int k = 0; k < K; k++) {
+      grad[k]->increment_vol_grad(vol[k], &dh[first[k]], y[t - 1]);
+      lnd_k[k] = grad[k]->calc_kernel_grad(vol[k], &dh[first[k]], y[t],
+                                           &dk[first[k]]);
+    }
+    
+    // one-step-ahead probabilities
+    for (int k = 0; k < K; k++) {
+      Ppred[k] = 0;
+      for (int l = 0; l < K; l++) Ppred[k] += Pspot[l] * inst.P_row[l * K + k];
+      for (int d = 0; d < D; d++) {
+        double tmp = 0;
+        for (int l = 0; l < K; l++) tmp += dPspot[l * D + d] * inst.P_row[l * K + k];
+        dPpred[k * D + d] = tmp;
+      }
+    }
+    for (int q = 0; q < nb_P; q++) {
+      int r = q / (K - 1), c = q % (K - 1);
+      dPpred[c * D + nb_coeffs + q] += Pspot[r];
+      dPpred[(K - 1) * D + nb_coeffs + q] -= Pspot[r];
+    }
+    
+    // filtered probabilities and loglikelihood increment, the kernels being
+    // shifted by 'delta' (in log space, see 'filter_method', by the maximum
+    // of 'log(Ppred[k]) + lnd_k[k]' as in 'HamiltonStepLog')
+    double delta;
+    if (filter_method() == 1) {
+      double a_max = log(Ppred[0]) + lnd_k[0];
+      for (int k = 1; k < K; k++)
+        a_max = std::max(a_max, log(Ppred[k]) + lnd_k[k]);
+      delta = -a_max;
+    } else {
+      double min_lnd = *std::min_element(lnd_k.begin(), lnd_k.end());
+      delta = ((min_lnd < LND_MIN) ? LND_MIN - min_lnd : 0);
+    }
+    double sum_f = 0;
+    std::fill(dS.begin(), dS.end(), 0.0);
+    for (int k = 0; k < K; k++) {
+      double e = exp(lnd_k[k] + delta);
+      f[k] = e * Ppred[k];
+      sum_f += f[k];
+      for (int d = 0; d < D; d++) df[k * D + d] = e * dPpred[k * D + d];
+      for (int d = first[k]; d < first[k] + NbParams[k]; d++)
+        df[k * D + d] += f[k] * dk[d];
+      for (int d = 0; d < D; d++) dS[d] += df[k * D + d];
+    }
+    lnd += -delta + log(sum_f);
+    for (int d = 0; d < D; d++) dlnd[d] += dS[d] / sum_f;
+    if (score)
+      for (int d = 0; d < D; d++)
+        score[d * (nb_obs - 1) + t - 1] = dS[d] / sum_f;
+    for (int k = 0; k < K; k++) {
+      Pspot[k] = f[k] / sum_f;
+      for (int d = 0; d < D; d++)
+        dPspot[k * D + d] = (df[k * D + d] - Pspot[k] * dS[d]) / sum_f;
+    }
   }
+  for (int k = 0; k < K; k++) delete grad[k];
   return lnd;
 }
 
+//------------------------------------- Batched Hamilton filter
+//-------------------------------------//
+// loglikelihood of 'nb' loaded copies of the models in a single pass over the
+// data; copy 'b' of model 'k' is 'batch[k * nb_block + b]' and volatilities
+// and kernels are stored in the same regime-major order, so that each
+// observation is used by the whole block before moving to the next one
+// (does not call the R API and can run on a worker thread)
+inline void MSgarch::filter_batch(const double* y, const int& nb_obs,
+                                  const int& nb, const double* P_b,
+                                  const double* P0_b, Base* const* batch,
+                                  const int& nb_block, double* lnd_b) const {
+  filter_batch_impl<DynamicRegimes>(y, nb_obs, nb, P_b, P0_b, batch, nb_block,
+                                    lnd_b);
+}
+
+template <typename Regimes>
+inline void MSgarch::filter_batch_impl(const double* y, const int& nb_obs,
+                                       const int& nb, const double* P_b,
+                                       const double* P0_b, Base* const* batch,
+                                       const int& nb_block,
+                                       double* lnd_b) const {
+  volatilityVector vol(K * nb_block);
+  std::vector<double> lnd_k(K * nb_block * MSGARCH_STEP_BLOCK);  // kernels
+  std::vector<double> Pspot(K * nb);  // Prob(St | I(t))
+  std::vector<double> Ppred(K * nb), work((2 * K + 1) * nb);
+  
+  // initialize volatilities and filters
+  for (int b = 0; b < nb; b++) {
+    for (int k = 0; k < K; k++) {
+      vol[k * nb_block + b] = batch[k * nb_block + b]->spec_set_vol(y[0]);
+      Pspot[b * K + k] = P0_b[b * K + k];
+    }
+  }
+  
+  // loop over blocks of observations
+  for (int first = 1; first < nb_obs; first += MSGARCH_STEP_BLOCK) {
+    int n = std::min(MSGARCH_STEP_BLOCK, nb_obs - first);
+    Regimes::step(batch, K, nb, nb_block, &vol[0], &lnd_k[0], y + first, n);
+    
+    // steps of the Hamilton filter for each vector of parameters (all
+    // together in log space, see 'HamiltonStepLog')
+    for (int i = 0; i < n; i++) {
+      if (filter_method() == 1) {
+        HamiltonStepLog(K, nb, P_b, &Pspot[0], &Ppred[0], &lnd_k[i],
+                        MSGARCH_STEP_BLOCK, nb_block * MSGARCH_STEP_BLOCK,
+                        &work[0], lnd_b);
+        continue;
+      }
+      for (int b = 0; b < nb; b++) {
+        lnd_b[b] += filter_step(P_b + b * K * K, &Pspot[b * K], &Ppred[0],
+                                &lnd_k[b * MSGARCH_STEP_BLOCK + i],
+                                nb_block * MSGARCH_STEP_BLOCK, &work[0]);
+      }
+    }
+  }
+}
+
 #endif  // MSgarch.h
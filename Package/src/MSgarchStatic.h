@@ -0,0 +1,77 @@
+#ifndef MSGARCHSTATIC_H  // include guard
+#define MSGARCHSTATIC_H
+
+#include "MSgarch.h"
+
+using namespace Rcpp;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//============================= MS-GARCH class with models known at compile time
+//==============================//
+
+// volatility and kernel steps of a block of copies of the models (see
+// 'DynamicRegimes'), where the type of each model is known so that the calls
+// are resolved (and inlined) at compile time; copy 'b' of model 'k' is
+// 'batch[k * nb_block + b]'
+template <typename... Regimes>
+struct StaticRegimes;
+
+template <>
+struct StaticRegimes<> {
+  static void step(Base* const*, const int&, const int&, const int&,
+                   volatility*, double*, const double*, const int&) {}
+  static bool check(const many&, const int&) { return true; }
+};
+
+template <typename Regime, typename... Rest>
+struct StaticRegimes<Regime, Rest...> {
+  static void step(Base* const* batch, const int& K, const int& nb,
+                   const int& nb_block, volatility* vol, double* lnd_k,
+                   const double* y, const int& n) {
+    double h[MSGARCH_STEP_BLOCK], lnh[MSGARCH_STEP_BLOCK];
+    for (int b = 0; b < nb; b++) {
+      Regime* spec = static_cast<Regime*>(batch[b]);
+      for (int i = 0; i < n; i++) {
+        spec->Regime::spec_increment_h(vol[b], y[i - 1]);
+        h[i] = vol[b].h, lnh[i] = vol[b].lnh;
+      }
+      spec->Regime::spec_set_lnh_block(h, lnh, n);
+      spec->Regime::spec_calc_kernel_block(h, lnh, y,
+                                           lnd_k + b * MSGARCH_STEP_BLOCK, n);
+    }
+    StaticRegimes<Rest...>::step(batch + nb_block, K, nb, nb_block,
+                                 vol + nb_block,
+                                 lnd_k + nb_block * MSGARCH_STEP_BLOCK, y, n);
+  }
+
+  // TRUE if model 'k' and the following ones have the expected types
+  static bool check(const many& specs, const int& k) {
+    return (dynamic_cast<Regime*>(specs[k]) != NULL) &&
+           StaticRegimes<Rest...>::check(specs, k + 1);
+  }
+};
+
+// MS-GARCH class for a given combination of models; only the batched
+// loglikelihood evaluation ('eval_model', through 'filter_batch') differs from
+// 'MSgarch', which remains the fallback for the combinations that are not
+// compiled. The filter of a single parameter set ('HamiltonFilter', used by
+// the filtered states and the forecasts), the gradient ('eval_model_grad') and
+// the simulations still go through the virtual interface of 'Base'
+template <typename... Regimes>
+class MSgarchStatic : public MSgarch {
+ public:
+  MSgarchStatic(List L) : MSgarch(L) {
+    if ((get_K() != (int)sizeof...(Regimes)) ||
+        !StaticRegimes<Regimes...>::check(specs, 0))
+      stop("models do not match the compiled MS-GARCH combination");
+  }
+
+  void filter_batch(const double* y, const int& nb_obs, const int& nb,
+                    const double* P_b, const double* P0_b, Base* const* batch,
+                    const int& nb_block, double* lnd_b) const {
+    filter_batch_impl<StaticRegimes<Regimes...> >(y, nb_obs, nb, P_b, P0_b,
+                                                  batch, nb_block, lnd_b);
+  }
+};
+
+#endif  // MSgarchStatic.h
@@ -36,6 +36,23 @@ class Normal {
     return lncst - 0.5 * pow(yi, 2) / vol.h - 0.5 * vol.lnh;
   }
 
+  // same as "kernel" for the "n" observations "y" with variances "h" (and
+  // their logarithms "lnh"), in "out"
+  void kernel_block(const double* h, const double* lnh, const double* y,
+                    double* out, const int& n) {
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+      out[i] = lncst - 0.5 * y[i] * y[i] / h[i] - 0.5 * lnh[i];
+  }
+
+  // derivatives of "kernel" with respect to the variance and the observation
+  double kernel_dh(const volatility& vol, const double& yi) {
+    return 0.5 * (pow(yi, 2) / vol.h - 1) / vol.h;
+  }
+  double kernel_dy(const volatility& vol, const double& yi) {
+    return -yi / vol.h;
+  }
+
   // returns PDF evaluated at "x"
   double pdf(const double& x) {
     prep_kernel();
@@ -52,6 +69,16 @@ class Normal {
 
   // applies inverse transform sampling on a Uniform(0,1) draw
   double invsample(const double& u) { return R::qnorm(u, 0, 1, 1, 0); }
+
+  // direct draw from the generator "gen" (see "RRng" and "Xoshiro"), and
+  // inverse transform free of the R API in place of the table of quantiles
+  // (not needed here as "qnorm" is not iterative)
+  template <typename Gen>
+  double rnd_direct(Gen& gen) {
+    return gen.norm();
+  }
+  void prep_table() {}
+  double invsample_table(const double& u) { return norm_quantile(u); }
 };
 
 #endif  // Normal.h
\ No newline at end of file
@@ -75,6 +75,28 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// set_filter_method
+int set_filter_method(const int& method);
+RcppExport SEXP _MSGARCH_set_filter_method(SEXP methodSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const int& >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_filter_method(method));
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_filter_scan
+int set_filter_scan(const int& scan);
+RcppExport SEXP _MSGARCH_set_filter_scan(SEXP scanSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const int& >::type scan(scanSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_filter_scan(scan));
+    return rcpp_result_gen;
+END_RCPP
+}
 // MapParameters_univ
 arma::vec MapParameters_univ(const arma::vec& vTheta_tilde, const std::string& Dist, const bool& bSkew);
 RcppExport SEXP _MSGARCH_MapParameters_univ(SEXP vTheta_tildeSEXP, SEXP DistSEXP, SEXP bSkewSEXP) {
@@ -140,6 +162,49 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// set_rnd_method
+int set_rnd_method(const int& method);
+RcppExport SEXP _MSGARCH_set_rnd_method(SEXP methodSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const int& >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_rnd_method(method));
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_sim_method
+int set_sim_method(const int& method);
+RcppExport SEXP _MSGARCH_set_sim_method(SEXP methodSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const int& >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_sim_method(method));
+    return rcpp_result_gen;
+END_RCPP
+}
+// set_nb_threads
+int set_nb_threads(const int& n);
+RcppExport SEXP _MSGARCH_set_nb_threads(SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const int& >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_nb_threads(n));
+    return rcpp_result_gen;
+END_RCPP
+}
+// get_nb_threads
+int get_nb_threads();
+RcppExport SEXP _MSGARCH_get_nb_threads() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(get_nb_threads());
+    return rcpp_result_gen;
+END_RCPP
+}
 
 RcppExport SEXP _rcpp_module_boot_eGARCH();
 RcppExport SEXP _rcpp_module_boot_Ged();
@@ -157,11 +222,17 @@ static const R_CallMethodDef CallEntries[] = {
     {"_MSGARCH_Viterbi", (DL_FUNC) &_MSGARCH_Viterbi, 3},
     {"_MSGARCH_EM_HMM", (DL_FUNC) &_MSGARCH_EM_HMM, 5},
     {"_MSGARCH_EM_MM", (DL_FUNC) &_MSGARCH_EM_MM, 5},
+    {"_MSGARCH_set_filter_method", (DL_FUNC) &_MSGARCH_set_filter_method, 1},
+    {"_MSGARCH_set_filter_scan", (DL_FUNC) &_MSGARCH_set_filter_scan, 1},
     {"_MSGARCH_MapParameters_univ", (DL_FUNC) &_MSGARCH_MapParameters_univ, 3},
     {"_MSGARCH_UnmapParameters_univ", (DL_FUNC) &_MSGARCH_UnmapParameters_univ, 3},
     {"_MSGARCH_SimplexUnmapping", (DL_FUNC) &_MSGARCH_SimplexUnmapping, 2},
     {"_MSGARCH_SimplexMapping", (DL_FUNC) &_MSGARCH_SimplexMapping, 2},
     {"_MSGARCH_dUnivLike", (DL_FUNC) &_MSGARCH_dUnivLike, 5},
+    {"_MSGARCH_set_rnd_method", (DL_FUNC) &_MSGARCH_set_rnd_method, 1},
+    {"_MSGARCH_set_sim_method", (DL_FUNC) &_MSGARCH_set_sim_method, 1},
+    {"_MSGARCH_set_nb_threads", (DL_FUNC) &_MSGARCH_set_nb_threads, 1},
+    {"_MSGARCH_get_nb_threads", (DL_FUNC) &_MSGARCH_get_nb_threads, 0},
     {"_rcpp_module_boot_eGARCH", (DL_FUNC) &_rcpp_module_boot_eGARCH, 0},
     {"_rcpp_module_boot_Ged", (DL_FUNC) &_rcpp_module_boot_Ged, 0},
     {"_rcpp_module_boot_gjrGARCH", (DL_FUNC) &_rcpp_module_boot_gjrGARCH, 0},
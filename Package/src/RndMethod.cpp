@@ -0,0 +1,13 @@
+#include <RcppArmadillo.h>
+#include "Utils.h"
+
+using namespace Rcpp;
+
+// sets the method used to draw the innovations (see 'rnd_method') and
+// returns the previous one
+// [[Rcpp::export]]
+int set_rnd_method(const int& method) {
+  int old = rnd_method();
+  rnd_method() = method;
+  return old;
+}
@@ -0,0 +1,169 @@
+#ifndef RNG_H  // include guard
+#define RNG_H
+
+#include <RcppArmadillo.h>
+#include <stdint.h>
+#include "Utils.h"
+using namespace Rcpp;
+
+// xoshiro256** generator (Blackman and Vigna, 2018) with its jump function:
+// independent streams that can be used away from the R API (e.g. on worker
+// threads), seeded from R's RNG so that 'set.seed' makes them reproducible
+class Xoshiro {
+  uint64_t s[4];
+  static inline uint64_t rotl(const uint64_t& x, const int& k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+ public:
+  Xoshiro() { s[0] = 1, s[1] = 2, s[2] = 3, s[3] = 4; }
+
+  // seeds the state from R's RNG (main thread only)
+  void seed_from_R() {
+    for (int i = 0; i < 4; i++) {
+      uint64_t hi = (uint64_t)(unif_rand() * 4294967296.0);
+      uint64_t lo = (uint64_t)(unif_rand() * 4294967296.0);
+      s[i] = (hi << 32) | lo;
+    }
+    if (!(s[0] | s[1] | s[2] | s[3])) s[0] = 1;  // the null state is absorbing
+  }
+
+  uint64_t next() {
+    const uint64_t out = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return out;
+  }
+
+  // advances the state by 2^128 draws
+  void jump() {
+    static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t t[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; i++) {
+      for (int b = 0; b < 64; b++) {
+        if (JUMP[i] & ((uint64_t)1 << b))
+          for (int j = 0; j < 4; j++) t[j] ^= s[j];
+        next();
+      }
+    }
+    for (int j = 0; j < 4; j++) s[j] = t[j];
+  }
+
+  // uniform draw in (0, 1)
+  double unif() { return ((next() >> 11) + 0.5) * (1.0 / 9007199254740992.0); }
+
+  // standard normal draw (by inversion)
+  double norm() { return norm_quantile(unif()); }
+
+  // standard gamma draw of shape 'a' (Marsaglia and Tsang, 2000)
+  double gamma(const double& a) {
+    if (a < 1) return gamma(a + 1) * pow(unif(), 1 / a);
+    double d = a - 1.0 / 3, c = 1 / sqrt(9 * d);
+    for (;;) {
+      double x, v;
+      do {
+        x = norm();
+        v = 1 + c * x;
+      } while (v <= 0);
+      v = v * v * v;
+      double w = unif();
+      if (w < 1 - 0.0331 * x * x * x * x) return d * v;
+      if (log(w) < 0.5 * x * x + d * (1 - v + log(v))) return d * v;
+    }
+  }
+};
+
+// same draws from R's RNG (main thread only), for the samplers of the
+// distributions that take the generator as a template parameter (see
+// 'rnd_direct')
+struct RRng {
+  RNGScope scope;
+  double unif() { return unif_rand(); }
+  double norm() { return norm_rand(); }
+  double gamma(const double& a) { return R::rgamma(a, 1); }
+};
+
+// number of paths drawn from one stream by the parallel simulators: the
+// streams are attached to blocks of paths and not to threads, so that the
+// draws depend on the seed only
+#define SIM_BLOCK_SIZE 256
+
+// 'n' independent streams: seeded once from R's RNG and one jump apart
+inline std::vector<Xoshiro> make_streams(const int& n) {
+  RNGScope scope;
+  std::vector<Xoshiro> out(std::max(n, 1));
+  out[0].seed_from_R();
+  for (int i = 1; i < n; i++) {
+    out[i] = out[i - 1];
+    out[i].jump();
+  }
+  return out;
+}
+
+// radical inverse of 'i' in base 'b' (the 'i'-th point of the van der
+// Corput sequence) with its first 'nb_digits' digits scrambled by the
+// permutations 'perm' ('perm[k * b + a]' is the image of the digit 'a' of
+// order 'k'), and the remaining ones given by 'tail' in [0, 1)
+inline double scrambled_radical_inverse(int i, const int& b, const int* perm,
+                                        const int& nb_digits,
+                                        const double& tail) {
+  double out = 0, f = 1.0 / b;
+  for (int k = 0; k < nb_digits; k++, i /= b, f /= b)
+    out += f * perm[k * b + i % b];
+  return out + f * b * tail;
+}
+
+// uniforms of 'm' paths of 'd' draws ('u[i * d + j]' for draw 'j' of path
+// 'i') for the variance reduction method 'method' (see 'sim_method'):
+// either antithetic pairs of paths ('u' and '1 - u'), or the Halton sequence
+// with one dimension per draw of a path, scrambled (Owen, 1995; Matousek,
+// 1998): in each dimension, the digits of each order are permuted at random,
+// which removes the correlations between the dimensions of large bases, and
+// the digits beyond those that tell the 'm' points apart are uniform, so
+// that each point is uniform and the estimates remain unbiased (the draws
+// use R's RNG)
+inline std::vector<double> sim_uniforms(const int& method, const int& m,
+                                        const int& d) {
+  RNGScope scope;
+  std::vector<double> u((size_t)m * d);
+  if (method == 1) {
+    for (int i = 0; i < m; i++)
+      for (int j = 0; j < d; j++)
+        u[(size_t)i * d + j] =
+            ((i % 2 == 0) ? unif_rand() : 1 - u[(size_t)(i - 1) * d + j]);
+    return u;
+  }
+  std::vector<int> primes;
+  for (int p = 2; (int)primes.size() < d; p++) {
+    bool is_prime = true;
+    for (size_t k = 0; k < primes.size() && primes[k] * primes[k] <= p; k++)
+      if (p % primes[k] == 0) is_prime = false;
+    if (is_prime) primes.push_back(p);
+  }
+  std::vector<int> perm;
+  for (int j = 0; j < d; j++) {
+    int b = primes[j], nb_digits = 1;
+    for (double bk = b; bk <= m; bk *= b) nb_digits++;  // b^nb_digits > m
+    perm.resize(nb_digits * b);
+    for (int k = 0; k < nb_digits; k++) {  // random permutations of the digits
+      int* pk = &perm[k * b];
+      for (int a = 0; a < b; a++) pk[a] = a;
+      for (int a = b - 1; a > 0; a--)
+        std::swap(pk[a], pk[std::min(a, (int)(unif_rand() * (a + 1)))]);
+    }
+    for (int i = 0; i < m; i++) {
+      double x = scrambled_radical_inverse(i, b, &perm[0], nb_digits,
+                                           unif_rand());
+      u[(size_t)i * d + j] = std::min(std::max(x, 1e-12), 1 - 1e-12);
+    }
+  }
+  return u;
+}
+
+#endif  // Rng.h
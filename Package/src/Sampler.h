@@ -0,0 +1,204 @@
+#ifndef SAMPLER_H  // include guard
+#define SAMPLER_H
+
+#include <RcppArmadillo.h>
+#include "Utils.h"
+#include "Rng.h"
+using namespace Rcpp;
+
+//------------------------ Parameter mapping ------------------------//
+// maps the unbounded parameters of the sampler to the parameters of the
+// model, as 'f_posterior' does in R (the list is set up by
+// 'f_SamplerMapping'): each parameter of the model is either a free
+// parameter mapped to its bounds or a fixed value, and the priors that
+// 'Kernel' removes are removed here as well
+struct ParMapping {
+  NumericVector lower, upper;  // bounds of the free parameters
+  IntegerVector idx;  // free parameter of each model parameter (-1 if fixed)
+  NumericVector val;  // value of the fixed model parameters
+  IntegerVector prior_idx;  // model parameters whose prior is removed
+  NumericVector prior_mean, prior_sd;
+  double prior_const;  // removed log-prior of the fixed parameters
+
+  ParMapping(List L) {
+    lower = as<NumericVector>(L["lower"]);
+    upper = as<NumericVector>(L["upper"]);
+    idx = as<IntegerVector>(L["idx"]);
+    val = as<NumericVector>(L["val"]);
+    prior_idx = as<IntegerVector>(L["prior_idx"]);
+    prior_mean = as<NumericVector>(L["prior_mean"]);
+    prior_sd = as<NumericVector>(L["prior_sd"]);
+    prior_const = as<double>(L["prior_const"]);
+  }
+
+  // fills 'theta' with the parameters of the model and returns the log of
+  // the Jacobian term of 'f_posterior'
+  double map(const double* x, NumericVector& theta) const {
+    int d = lower.size();
+    double jac = 0;
+    std::vector<double> par(d);
+    for (int i = 0; i < d; i++) {
+      par[i] = lower[i] + (upper[i] - lower[i]) / (1 + exp(-x[i]));
+      jac += exp(-x[i] + log(upper[i] - lower[i]) - 2 * log(1 + exp(-x[i])));
+    }
+    for (int m = 0; m < idx.size(); m++)
+      theta[m] = ((idx[m] >= 0) ? par[idx[m]] : val[m]);
+    return log(jac);
+  }
+
+  // log-prior of the model parameters removed from the kernel
+  double removed_prior(const NumericVector& theta) const {
+    double out = prior_const;
+    for (int i = 0; i < prior_idx.size(); i++)
+      out += R::dnorm(theta[prior_idx[i]], prior_mean[i], prior_sd[i], 1);
+    return out;
+  }
+};
+
+// log-posterior of the sampler's parameters 'x' ('theta' is a workspace of
+// the size of the model parameters); 'Spec' must have 'eval_theta'
+template <typename Spec>
+double ram_posterior(Spec& spec, const ParMapping& mapping, const double* x,
+                     const NumericVector& y, NumericVector& theta) {
+  double log_jac = mapping.map(x, theta);
+  double out = spec.eval_theta(theta, y, true) - mapping.removed_prior(theta);
+  if (IsInfNan(out)) out = -1e10;
+  out += log_jac;
+  if (IsInfNan(out)) out = -1e10;
+  return out;
+}
+
+//------------------------ Adaptive Metropolis ------------------------//
+// robust adaptive random-walk Metropolis sampler of Vihola (2012), as in
+// 'adaptMCMC::MCMC' with 'adapt = TRUE': the Cholesky factor 'S' of the
+// proposal covariance is adapted at each draw so as to reach the acceptance
+// rate 'acc_rate'
+struct RamChain {
+  int d;
+  arma::vec x, x_prop, u;  // current state, proposal and its innovation
+  arma::mat S, I;
+  double post;  // log-posterior at 'x'
+
+  RamChain(const double* x0, const int& d_) : d(d_), x(x0, d_), x_prop(d_),
+      u(d_), S(arma::eye(d_, d_)), I(arma::eye(d_, d_)) {}
+
+  // proposal from the standard normal innovations in 'u'
+  void propose() { x_prop = x + S * u; }
+
+  // accepts or rejects the proposal given its log-posterior and a uniform
+  // draw, and adapts 'S' at draw 't' (the factor is kept when the update is
+  // not positive definite, where 'adaptMCMC' takes the nearest positive
+  // definite matrix)
+  void step(const double& post_prop, const double& unif, const int& t,
+            const double& acc_rate) {
+    double alpha = std::min(1.0, exp(post_prop - post));
+    if (IsInfNan(alpha)) alpha = 0;
+    if (unif < alpha) {
+      x = x_prop;
+      post = post_prop;
+    }
+    double rate = std::min(5.0, d * pow(t + 1.0, -2.0 / 3.0));
+    arma::mat M = S * (I + rate * (alpha - acc_rate) * u * u.t() /
+                               arma::dot(u, u)) * S.t();
+    arma::mat S_new;
+    if (arma::chol(S_new, M, "lower")) S = S_new;
+  }
+};
+
+// single chain with R's RNG; returns the 'n' draws (the first one is 'par0')
+template <typename Spec>
+NumericMatrix ram_sampler(Spec& spec, const NumericVector& y,
+                          const NumericVector& par0, const List& L,
+                          const int& n, const double& acc_rate) {
+  RNGScope scope;
+  ParMapping mapping(L);
+  int d = par0.size();
+  NumericMatrix draws(n, d);
+  NumericVector theta(mapping.idx.size());
+  RamChain chain(par0.begin(), d);
+  chain.post = ram_posterior(spec, mapping, chain.x.memptr(), y, theta);
+  if (n > 0)
+    for (int i = 0; i < d; i++) draws(0, i) = chain.x(i);
+  for (int t = 1; t < n; t++) {
+    for (int i = 0; i < d; i++) chain.u(i) = norm_rand();
+    chain.propose();
+    double post_prop =
+        ram_posterior(spec, mapping, chain.x_prop.memptr(), y, theta);
+    chain.step(post_prop, unif_rand(), t, acc_rate);
+    for (int i = 0; i < d; i++) draws(t, i) = chain.x(i);
+  }
+  return draws;
+}
+
+// log-posteriors of the proposals of all the chains, evaluated together by
+// 'eval_model' ('thetas', 'theta' and 'log_jac' are workspaces)
+template <typename Spec>
+void ram_posterior_chains(Spec& spec, const ParMapping& mapping,
+                          std::vector<RamChain>& chains,
+                          const NumericVector& y, NumericMatrix& thetas,
+                          NumericVector& theta, std::vector<double>& log_jac,
+                          std::vector<double>& out) {
+  int nb_chains = chains.size();
+  for (int c = 0; c < nb_chains; c++) {
+    log_jac[c] = mapping.map(chains[c].x_prop.memptr(), theta);
+    thetas(c, _) = theta;
+  }
+  NumericVector lnd = spec.eval_model(thetas, y, true);
+  for (int c = 0; c < nb_chains; c++) {
+    theta = thetas(c, _);
+    double tmp = lnd[c] - mapping.removed_prior(theta);
+    if (IsInfNan(tmp)) tmp = -1e10;
+    tmp += log_jac[c];
+    out[c] = (IsInfNan(tmp) ? -1e10 : tmp);
+  }
+}
+
+// independent chains started at the rows of 'par0', each with its own
+// random stream (see 'Rng.h'); at each draw the proposals of all the chains
+// are evaluated together by 'eval_model', which spreads them over the
+// threads. Returns the list of the 'n' draws of each chain
+template <typename Spec>
+List ram_sampler_chains(Spec& spec, const NumericVector& y,
+                        const NumericMatrix& par0, const List& L,
+                        const int& n, const double& acc_rate) {
+  RNGScope scope;
+  ParMapping mapping(L);
+  int nb_chains = par0.nrow(), d = par0.ncol();
+  int nb_par = mapping.idx.size();
+  std::vector<Xoshiro> rng = make_streams(nb_chains);
+  std::vector<RamChain> chains;
+  std::vector<NumericMatrix> draws;
+  std::vector<double> log_jac(nb_chains), post(nb_chains);
+  NumericMatrix thetas(nb_chains, nb_par);
+  NumericVector theta(nb_par);
+  for (int c = 0; c < nb_chains; c++) {
+    std::vector<double> x0(d);
+    for (int i = 0; i < d; i++) x0[i] = par0(c, i);
+    chains.push_back(RamChain(&x0[0], d));
+    draws.push_back(NumericMatrix(n, d));
+  }
+
+  for (int c = 0; c < nb_chains; c++) chains[c].x_prop = chains[c].x;
+  ram_posterior_chains(spec, mapping, chains, y, thetas, theta, log_jac, post);
+  for (int c = 0; c < nb_chains; c++) {
+    chains[c].post = post[c];
+    if (n > 0)
+      for (int i = 0; i < d; i++) draws[c](0, i) = chains[c].x(i);
+  }
+  for (int t = 1; t < n; t++) {
+    for (int c = 0; c < nb_chains; c++) {
+      for (int i = 0; i < d; i++) chains[c].u(i) = rng[c].norm();
+      chains[c].propose();
+    }
+    ram_posterior_chains(spec, mapping, chains, y, thetas, theta, log_jac, post);
+    for (int c = 0; c < nb_chains; c++) {
+      chains[c].step(post[c], rng[c].unif(), t, acc_rate);
+      for (int i = 0; i < d; i++) draws[c](t, i) = chains[c].x(i);
+    }
+  }
+  List out(nb_chains);
+  for (int c = 0; c < nb_chains; c++) out[c] = draws[c];
+  return out;
+}
+
+#endif  // Sampler.h
@@ -0,0 +1,13 @@
+#include <RcppArmadillo.h>
+#include "Utils.h"
+
+using namespace Rcpp;
+
+// sets the variance reduction of the simulations ahead of the data (see
+// 'sim_method') and returns the previous one
+// [[Rcpp::export]]
+int set_sim_method(const int& method) {
+  int old = sim_method();
+  sim_method() = method;
+  return old;
+}
@@ -3,11 +3,26 @@
 
 #include <RcppArmadillo.h>
 #include "Utils.h"
+#include "Rng.h"
+#include "Sampler.h"
 using namespace Rcpp;
 
 // The class "SingleRegime" below is templated in terms of the model to use
 // (e.g. Garch<Symmetric<Normal> >)
 
+/// derivatives of a model at one vector of parameters with respect to its
+/// coefficients (one per coefficient in 'dh' and 'dk'), see 'spec_grad'
+class BaseGrad {
+ public:
+  virtual volatility set_vol_grad(const double&, double*) = 0;
+  virtual double increment_vol_grad(volatility&, double*, const double&) = 0;
+  virtual double calc_kernel_grad(const volatility&, const double*,
+                                  const double&, double*) = 0;
+
+  virtual ~BaseGrad() = 0;
+};
+inline BaseGrad::~BaseGrad() {}
+
 /// Base virtual class with polymorphic abilities
 class Base {
  public:
@@ -34,21 +49,284 @@ class Base {
   virtual bool spec_calc_r1() = 0;
   virtual volatility spec_set_vol(const double&) = 0;
   virtual void spec_increment_vol(volatility&, const double&) = 0;
+  // two-phase increments: the variance recursion alone, then the
+  // logarithms of a block of variances
+  virtual void spec_increment_h(volatility&, const double&) = 0;
+  virtual void spec_set_lnh_block(const double*, double*, const int&) = 0;
   virtual void spec_prep_kernel() = 0;
   virtual NumericVector spec_rndgen(const int&) = 0;
+  virtual double spec_invsample(const double&) = 0;
+  virtual void spec_prep_rnd() = 0;  // to be called before 'spec_invsample'
+  // inverse transform free of the R API, for the worker threads (see
+  // 'sim_parallel'); 'spec_prep_table' must be called first, on the main
+  // thread
+  virtual double spec_invsample_table(const double&) = 0;
+  virtual void spec_prep_table() = 0;
+  // draw from a random stream by the method 'method' (see 'rnd_method'),
+  // free of the R API unless 'method' is 0 (the table must be ready if it
+  // is 2)
+  virtual double spec_draw(Xoshiro&, const int&) = 0;
+  virtual double spec_draw(RRng&, const int&) = 0;  // main thread only
+  virtual bool spec_forecast_coeffs(double*) = 0;
   virtual double spec_calc_pdf(const double&) = 0;
   virtual double spec_calc_cdf(const double&) = 0;
   virtual double spec_calc_kernel(const volatility&, const double&) = 0;
+  // kernels of 'n' observations (at most KERNEL_BLOCK_SIZE) given their
+  // variances and the logarithms of these
+  virtual void spec_calc_kernel_block(const double*, const double*,
+                                      const double*, double*, const int&) = 0;
+  // derivatives with respect to the coefficients at the parameters 'theta',
+  // allocated with 'new' (on the main thread, as it calls the R API); the
+  // model itself is left untouched
+  virtual BaseGrad* spec_grad(const NumericVector&) const = 0;
+  // adds the derivatives of the log-prior (one per coefficient) to 'dr'
+  virtual void spec_calc_prior_grad(const NumericVector&, double*) = 0;
+  // returns a copy (including loaded parameters) allocated with 'new'
+  virtual Base* clone() = 0;
 
   virtual ~Base() = 0;
 };
 inline Base::~Base() {}
 
+// predictive distribution of a mixture of scaled models (e.g. the regimes of
+// several vectors of parameters), with its Value-at-Risk and
+// Expected-shortfall (see 'f_risk'); the models must stay loaded
+#define RISK_SIMPSON_DEPTH 50
+#define RISK_ES_NODES 64
+struct RiskMixture {
+  std::vector<Base*> models;    // model of each component
+  std::vector<double> w, sig;   // weights and scales of the components
+  double target;                // level of the quantile being solved for
+
+  void add(Base* model, const double& weight, const double& scale) {
+    if (weight <= 0) return;
+    models.push_back(model), w.push_back(weight), sig.push_back(scale);
+  }
+
+  double cdf(const double& x) {
+    double out = 0;
+    for (size_t i = 0; i < w.size(); i++)
+      out += w[i] * models[i]->spec_calc_cdf(x / sig[i]);
+    return out;
+  }
+
+  double cdf_gap(const double& x) { return cdf(x) - target; }
+
+  // 'x' times the density at 'x'
+  double xpdf(const double& x) {
+    double out = 0;
+    for (size_t i = 0; i < w.size(); i++)
+      out += w[i] * models[i]->spec_calc_pdf(x / sig[i]) / sig[i];
+    return x * out;
+  }
+
+  // quantile at level 'p', by Brent's method on a bracket that is widened
+  // until it holds the quantile; NA if no bracket is found (e.g. for
+  // degenerate scales)
+  double quantile(const double& p) {
+    double scale = *std::max_element(sig.begin(), sig.end());
+    double lo = -10 * scale, hi = 10 * scale;
+    for (int i = 0; i < 60 && cdf(lo) > p; i++) lo *= 2;
+    for (int i = 0; i < 60 && cdf(hi) < p; i++) hi *= 2;
+    if (!(cdf(lo) <= p) || !(cdf(hi) >= p)) return NA_REAL;
+    target = p;
+    return brentRoot(&RiskMixture::cdf_gap, this, lo, hi, 1e-10 * scale, 200);
+  }
+
+  // Expected-shortfall at level 'p' given the Value-at-Risk 'VaR': the
+  // integral of 'xpdf' below 'VaR' divided by 'p', by adaptive quadrature
+  // (at most RISK_SIMPSON_DEPTH halvings) from the quantile at level '1e-8 p'
+  // (the tail below is neglected). If the quadrature does not converge, it
+  // falls back to the average of the quantiles bracketed by Brent's method
+  // at RISK_ES_NODES levels regularly spaced in (0, p)
+  double shortfall(const double& p, const double& VaR) {
+    double lo = quantile(1e-8 * p);
+    if (ISNAN(lo) || ISNAN(VaR)) return NA_REAL;
+    bool converged;
+    double out = adaptiveSimpsons(&RiskMixture::xpdf, this, lo, VaR, 1e-8,
+                                  RISK_SIMPSON_DEPTH, &converged) / p;
+    if (converged && (out >= lo) && (out <= VaR)) return out;
+    out = 0;
+    for (int j = 0; j < RISK_ES_NODES; j++)
+      out += quantile(p * (j + 0.5) / RISK_ES_NODES);
+    return out / RISK_ES_NODES;
+  }
+
+  // Value-at-Risk (and Expected-shortfall if 'do_es') at the levels 'alpha',
+  // stored in row 'i' of 'VaR' (and 'ES'); returns the number of levels whose
+  // quantile could not be bracketed (left NA, see 'risk_warning')
+  int risk(const NumericVector& alpha, const bool& do_es, const int& i,
+           NumericMatrix& VaR, NumericMatrix& ES) {
+    int nb_na = 0;
+    for (int a = 0; a < alpha.size(); a++) {
+      VaR(i, a) = quantile(alpha[a]);
+      if (do_es) ES(i, a) = shortfall(alpha[a], VaR(i, a));
+      nb_na += ISNAN(VaR(i, a));
+    }
+    return nb_na;
+  }
+};
+
+// warns once for the 'nb_na' risk measures left NA by 'RiskMixture::risk'
+inline void risk_warning(const int& nb_na) {
+  if (nb_na > 0)
+    Rcpp::warning("the Value-at-Risk could not be bracketed at %i level(s) "
+                  "and is NA", nb_na);
+}
+
+//------------------------ Derivatives ------------------------//
+// derivatives of the instance 'mod' (parameters 'theta' loaded, kernel
+// prepared): those with respect to the coefficients of the model are
+// analytic; those with respect to the coefficients of the distribution are
+// not, and combine the analytic derivative of the kernel in "h" with central
+// differences of the single steps, taken on the copies 'mod_eps' whose
+// coefficients are moved by +/- 'eps'
+template <typename Model>
+class ModelGrad : public BaseGrad {
+  Model mod;
+  std::vector<Model> mod_eps;
+  std::vector<double> eps;
+
+ public:
+  ModelGrad(const Model& m, const NumericVector& theta) : mod(m) {
+    int nb_dist = mod.nb_coeffs - mod.nb_coeffs_model;
+    mod_eps.assign(2 * nb_dist, mod);
+    eps.resize(nb_dist);
+    for (int i = 0; i < nb_dist; i++) {
+      int ind = mod.nb_coeffs_model + i;
+      eps[i] = 1e-5 * std::max(1.0, fabs(theta[ind]));
+      for (int s = 0; s < 2; s++) {
+        NumericVector theta_s(theta.begin(), theta.end());
+        theta_s[ind] += ((s == 0) ? eps[i] : -eps[i]);
+        mod_eps[2 * i + s].loadparam(theta_s);
+        mod_eps[2 * i + s].prep_ineq_vol();
+        mod_eps[2 * i + s].prep_kernel();
+      }
+    }
+  }
+
+  volatility set_vol_grad(const double& y0, double* dh) {
+    volatility out = mod.set_vol_grad(y0, dh);
+    for (int i = 0; i < (int)eps.size(); i++) {
+      dh[mod.nb_coeffs_model + i] = (mod_eps[2 * i].set_vol(y0).h -
+                                     mod_eps[2 * i + 1].set_vol(y0).h) /
+                                    (2 * eps[i]);
+    }
+    return out;
+  }
+  double increment_vol_grad(volatility& vol, double* dh, const double& yim1) {
+    volatility vol_m1 = vol, vol_up, vol_dn;
+    double out = mod.increment_vol_grad(vol, dh, yim1);
+    for (int i = 0; i < (int)eps.size(); i++) {
+      vol_up = vol_m1, vol_dn = vol_m1;
+      mod_eps[2 * i].increment_vol(vol_up, yim1);
+      mod_eps[2 * i + 1].increment_vol(vol_dn, yim1);
+      double* dh_i = dh + mod.nb_coeffs_model + i;
+      *dh_i = (vol_up.h - vol_dn.h) / (2 * eps[i]) + out * (*dh_i);
+    }
+    return out;
+  }
+  double calc_kernel_grad(const volatility& vol, const double* dh,
+                          const double& yi, double* dk) {
+    double kernel_dh = mod.calc_kernel_dh(vol, yi);
+    for (int i = 0; i < mod.nb_coeffs; i++) dk[i] = kernel_dh * dh[i];
+    for (int i = 0; i < (int)eps.size(); i++) {
+      dk[mod.nb_coeffs_model + i] += (mod_eps[2 * i].calc_kernel(vol, yi) -
+                                      mod_eps[2 * i + 1].calc_kernel(vol, yi)) /
+                                     (2 * eps[i]);
+    }
+    return mod.calc_kernel(vol, yi);
+  }
+};
+
 //------------------------ Master class ------------------------//
 template <typename Model>
 class SingleRegime : public Base {
   Model spec;
 
+  // copy of 'spec' with the parameters 'theta' loaded: the methods that
+  // filter, evaluate or simulate given parameters work on an instance of
+  // their own and leave 'spec' untouched (see 'MSgarchInstance')
+  Model instance(const NumericVector& theta) const {
+    Model out(spec);
+    out.loadparam(theta);
+    out.prep_ineq_vol();
+    out.prep_kernel();
+    return out;
+  }
+
+  // prior of the instance 'mod' with the parameters 'theta' loaded
+  static prior calc_prior(Model&, const NumericVector&);
+
+  // same, as a model of its own (e.g. for 'RiskMixture')
+  Base* clone_instance(const NumericVector& theta) const {
+    SingleRegime<Model>* out = new SingleRegime<Model>(*this);
+    out->spec = instance(theta);
+    return out;
+  }
+
+  // loglikelihood of the observations 'y[1]' to 'y[nb_obs - 1]' given the
+  // model 'mod' (with its kernel prepared), by blocks of KERNEL_BLOCK_SIZE
+  // observations in two phases: the variance recursion alone runs along the
+  // block (see 'increment_h'), then the logarithms of the variances and the
+  // kernels of the block are computed together, out of the sequential
+  // dependency (see 'set_lnh_block' and 'calc_kernel_block')
+  static double calc_lnd(Model& mod, const double* y, const int& nb_obs) {
+    double h[KERNEL_BLOCK_SIZE], lnh[KERNEL_BLOCK_SIZE];
+    double lnd_i[KERNEL_BLOCK_SIZE];
+    double out = 0;
+    volatility vol = mod.set_vol(y[0]);  // initialize volatility
+    for (int first = 1; first < nb_obs; first += KERNEL_BLOCK_SIZE) {
+      int n = std::min(KERNEL_BLOCK_SIZE, nb_obs - first);
+      for (int i = 0; i < n; i++) {  // increment volatility
+        mod.increment_h(vol, y[first + i - 1]);
+        h[i] = vol.h, lnh[i] = vol.lnh;
+      }
+      mod.set_lnh_block(h, lnh, n);
+      mod.calc_kernel_block(h, lnh, y + first, lnd_i, n);
+      for (int i = 0; i < n; i++) out += lnd_i[i];  // increment kernel
+    }
+    return out;
+  }
+
+  // path 'i' of 'n' observations of the instance 'mod' from the volatility
+  // 'vol0' or, if null, from the one set by its first innovation; the
+  // innovations are drawn from 'gen' by the method 'method' (see
+  // 'rnd_method') or, if 'u' is not null, inverted from the uniforms 'u[0]'
+  // to 'u[n - 1]' on the table of quantiles. The serial and parallel
+  // simulators share it, so that their draws differ by the stream only
+  template <typename Gen>
+  static void sim_path(Model& mod, Gen& gen, const int& method,
+                       const double* u, const int& n, const int& i,
+                       const volatility* vol0, NumericMatrix& y,
+                       NumericMatrix& CondVol) {
+    double z = ((u) ? mod.invsample_table(*u++) : mod.draw(gen, method));
+    volatility vol = ((vol0) ? *vol0 : mod.set_vol(z));
+    for (int t = 0; t < n; t++) {
+      if (t > 0) {
+        mod.increment_vol(vol, y(i, t - 1));
+        z = ((u) ? mod.invsample_table(*u++) : mod.draw(gen, method));
+      }
+      y(i, t) = z * sqrt(vol.h);
+      CondVol(i, t) = sqrt(vol.h);
+    }
+  }
+  // simulation of the paths of the instance 'mod' on several threads, or
+  // on the main thread from R's RNG (see 'f_sim')
+  void sim_parallel(Model&, const int&, const int&, const volatility*,
+                    NumericMatrix&, NumericMatrix&, const double* = NULL) const;
+  void sim_serial(Model& mod, const int& n, const int& m,
+                  const volatility* vol0, NumericMatrix& y,
+                  NumericMatrix& CondVol) const {
+    RRng gen;
+    mod.prep_rnd();
+    for (int i = 0; i < m; i++)
+      sim_path(mod, gen, rnd_method(), NULL, n, i, vol0, y, CondVol);
+  }
+  // paths of the instance 'mod' from a one-step-ahead volatility (see
+  // 'f_simAhead')
+  List sim_ahead(Model&, const volatility&, const int&, const int&);
+
  public:
   std::string name;
   NumericVector theta0;
@@ -76,11 +354,12 @@ class SingleRegime : public Base {
 
   // functions accessible from R
   double ineq_func(const NumericVector& theta) {
-    spec.loadparam(theta);
-    spec.prep_ineq_vol();
-    return spec.ineq_func();
+    Model mod = instance(theta);
+    return mod.ineq_func();
+  }
+  prior calc_prior(const NumericVector& theta) {
+    return calc_prior(spec, theta);
   }
-  prior calc_prior(const NumericVector&);
   List f_sim(const int&, const int&, const NumericVector&);
   NumericVector f_pdf(const NumericVector&, const NumericVector&,
                       const NumericVector&, const bool&);
@@ -94,8 +373,44 @@ class SingleRegime : public Base {
   NumericVector f_unc_vol(NumericMatrix&, const NumericVector&);
   NumericMatrix calc_ht(NumericMatrix&, const NumericVector&);
   NumericVector eval_model(NumericMatrix&, const NumericVector&, const bool&);
+  List eval_model_grad(NumericMatrix&, const NumericVector&, const bool&);
+  NumericMatrix eval_model_score(const NumericVector&, const NumericVector&);
+  double eval_theta(const NumericVector&, const NumericVector&, const bool&);
+  NumericMatrix f_mcmc(const NumericVector& y, const NumericVector& par0,
+                       const List& mapping, const int& n,
+                       const double& acc_rate) {
+    return ram_sampler(*this, y, par0, mapping, n, acc_rate);
+  }
+  List f_mcmc_chains(const NumericVector& y, const NumericMatrix& par0,
+                     const List& mapping, const int& n,
+                     const double& acc_rate) {
+    return ram_sampler_chains(*this, y, par0, mapping, n, acc_rate);
+  }
+  double calc_lnd_grad(const NumericVector&, const NumericVector&, double*,
+                       double*) const;
+  // state of the volatility filter after 'y' for each vector of parameters,
+  // and the same state advanced by new observations
+  List f_filter_init(NumericMatrix&, const NumericVector&);
+  List f_filter_update(NumericMatrix&, const List&, const NumericVector&);
   List f_simAhead(const NumericVector&, const int&,  const int&,
                            const NumericVector&, const NumericVector&);
+  List f_simAhead_filter(const List&, const int&, const int&, const int&,
+                         const NumericVector&);
+  // expected variance of the 'n_ahead' next observations after 'y', or
+  // after a filter state
+  NumericMatrix f_forecast_var(NumericMatrix&, const NumericVector&,
+                               const int&);
+  NumericMatrix f_forecast_var_filter(NumericMatrix&, const List&,
+                                      const int&);
+  // predictive PDF (or CDF) at 'x' one step after a filter state
+  NumericVector f_pred_filter(const NumericVector&, NumericMatrix&,
+                              const List&, const bool&);
+  // Value-at-Risk and Expected-shortfall of the predictive distribution
+  List f_risk(NumericMatrix&, const NumericVector&, const NumericVector&,
+              const bool&, const bool&);
+  // same, one step after a filter state (see 'f_filter_init')
+  List f_risk_filter(NumericMatrix&, const List&, const NumericVector&,
+                     const bool&);
   // Handles to 'spec' data members
   std::string spec_name() { return spec.name; }
   NumericVector spec_theta0() { return spec.coeffs_mean; }
@@ -129,26 +444,60 @@ class SingleRegime : public Base {
   void spec_increment_vol(volatility& vol, const double& yim1) {
     spec.increment_vol(vol, yim1);
   }
+  void spec_increment_h(volatility& vol, const double& yim1) {
+    spec.increment_h(vol, yim1);
+  }
+  void spec_set_lnh_block(const double* h, double* lnh, const int& n) {
+    spec.set_lnh_block(h, lnh, n);
+  }
   void spec_prep_kernel() { spec.prep_kernel(); }
   NumericVector spec_rndgen(const int& n) { return spec.rndgen(n); }
+  double spec_invsample(const double& u) { return spec.invsample(u); }
+  void spec_prep_rnd() { spec.prep_rnd(); }
+  double spec_invsample_table(const double& u) {
+    return spec.invsample_table(u);
+  }
+  void spec_prep_table() { spec.prep_table(); }
+  double spec_draw(Xoshiro& gen, const int& method) {
+    return spec.draw(gen, method);
+  }
+  double spec_draw(RRng& gen, const int& method) {
+    return spec.draw(gen, method);
+  }
+  bool spec_forecast_coeffs(double* c) { return spec.forecast_coeffs(c); }
   double spec_calc_pdf(const double& x) { return spec.calc_pdf(x); }
   double spec_calc_cdf(const double& x) { return spec.calc_cdf(x); }
   double spec_calc_kernel(const volatility& vol, const double& yi) {
     return spec.calc_kernel(vol, yi);
   }
+  void spec_calc_kernel_block(const double* h, const double* lnh,
+                              const double* y, double* out, const int& n) {
+    spec.calc_kernel_block(h, lnh, y, out, n);
+  }
+  Base* clone() { return new SingleRegime<Model>(*this); }
+
+  // derivatives at 'theta' (see 'ModelGrad')
+  BaseGrad* spec_grad(const NumericVector& theta) const {
+    return new ModelGrad<Model>(instance(theta), theta);
+  }
+  // adds the derivatives of the log-prior 'r3' to 'dr'
+  void spec_calc_prior_grad(const NumericVector& theta, double* dr) {
+    for (int i = 0; i < spec.nb_coeffs; i++)
+      dr[i] -= (theta[i] - spec.coeffs_mean[i]) / pow(spec.coeffs_sd[i], 2);
+  }
 };
 
 //---------------------- Prior calculation ----------------------//
 template <typename Model>
-prior SingleRegime<Model>::calc_prior(const NumericVector& theta) {
-  bool r1 = spec.calc_r1();
+prior SingleRegime<Model>::calc_prior(Model& mod, const NumericVector& theta) {
+  bool r1 = mod.calc_r1();
   double r2 = -1e10;
   double r3 = 0;
   if (r1) {
     r2 = 0;
     r3 = 0;
-    for (int i = 0; i < spec.nb_coeffs; i++) {
-      r3 += R::dnorm(theta[i], spec.coeffs_mean[i], spec.coeffs_sd[i], 1);
+    for (int i = 0; i < mod.nb_coeffs; i++) {
+      r3 += R::dnorm(theta[i], mod.coeffs_mean[i], mod.coeffs_sd[i], 1);
     }
   }
   prior out;
@@ -159,27 +508,51 @@ prior SingleRegime<Model>::calc_prior(const NumericVector& theta) {
 }
 
 //---------------------- Model simulation ----------------------//
+// with more than one thread (see 'SetThreads'), the simulators draw from the
+// random streams of 'Rng.h' (seeded from R's RNG) instead of R's RNG: the
+// 'm' paths of length 'n' are simulated in parallel by blocks of
+// SIM_BLOCK_SIZE paths with one stream each, and start from the volatility
+// 'vol0' or, if null, from the one set by their first innovation; if 'u' is
+// not null, the 'n' innovations of path 'i' are drawn from the uniforms
+// 'u[i * n]' to 'u[i * n + n - 1]' instead (see 'sim_uniforms'). The
+// innovations are drawn by the method 'rnd_method_thread', the exact inverse
+// transform falling back to the table of quantiles, and the uniforms 'u' are
+// inverted on this table; it is built beforehand on the main thread, so that
+// the workers never call the R API
+template <typename Model>
+void SingleRegime<Model>::sim_parallel(Model& inst, const int& n,
+                                       const int& m, const volatility* vol0,
+                                       NumericMatrix& y,
+                                       NumericMatrix& CondVol,
+                                       const double* u) const {
+  int nb_thread = std::max(1, nb_threads());
+  int nb_blocks = (m + SIM_BLOCK_SIZE - 1) / SIM_BLOCK_SIZE;
+  std::vector<Xoshiro> rng = make_streams(nb_blocks);
+  int method = ((u) ? 2 : rnd_method_thread());
+  if (method == 2) inst.prep_table();
+  std::vector<Model> models(nb_thread, inst);  // one copy per thread
+#pragma omp parallel for schedule(dynamic) num_threads(nb_thread)
+  for (int b = 0; b < nb_blocks; b++) {
+    Model& mod = models[thread_id()];
+    int i_end = std::min(m, (b + 1) * SIM_BLOCK_SIZE);
+    for (int i = b * SIM_BLOCK_SIZE; i < i_end; i++)
+      sim_path(mod, rng[b], method, ((u) ? u + (size_t)i * n : NULL), n, i,
+               vol0, y, CondVol);
+  }
+}
+
 template <typename Model>
 List SingleRegime<Model>::f_sim(const int& n,
                                          const int& m,
                                          const NumericVector& theta) {
-  spec.loadparam(theta);  // load parameters
-  NumericVector z(n);
-  spec.prep_ineq_vol();  // prepare functions related to volatility
-  volatility vol;  // initialize volatility
+  Model mod = instance(theta);  // load parameters
   NumericMatrix y(m,n);
   NumericMatrix CondVol(m,n);
-  for (int i = 0; i < m; i++){
-	   z   = spec.rndgen(n);
-	   vol = spec.set_vol(z[0]);
-	   CondVol(i,0) = sqrt(vol.h);
-	   y(i,0) = z[0] * sqrt(vol.h);
-		for (int t = 1; t < n; t++) {
-			spec.increment_vol(vol, y(i, t - 1));
-			y(i,t) = z[t] * sqrt(vol.h);
-			CondVol(i,t) = sqrt(vol.h);
-		}
-	}
+  if (nb_threads() > 1) {
+    sim_parallel(mod, n, m, NULL, y, CondVol);
+  } else {
+    sim_serial(mod, n, m, NULL, y, CondVol);
+  }
   return (List::create(Rcpp::Named("draws") = y, Rcpp::Named("CondVol") = CondVol));
 }
 
@@ -190,11 +563,10 @@ NumericVector SingleRegime<Model>::f_pdf(const NumericVector& x,
                                          const NumericVector& y,
                                          const bool& is_log) {
   // computes volatility
-  spec.loadparam(theta);  // load parameters
-  spec.prep_ineq_vol();   // prepare functions related to volatility
-  volatility vol = spec.set_vol(y[0]);  // initialize volatility
+  Model mod = instance(theta);  // load parameters
+  volatility vol = mod.set_vol(y[0]);  // initialize volatility
   int ny = y.size();
-  for (int t = 0; t < ny; t++) spec.increment_vol(vol, y[t]);
+  for (int t = 0; t < ny; t++) mod.increment_vol(vol, y[t]);
   double sig = sqrt(vol.h);
 
   // computes PDF
@@ -202,7 +574,7 @@ NumericVector SingleRegime<Model>::f_pdf(const NumericVector& x,
   double tmp;
   NumericVector out(nx);
   for (int i = 0; i < nx; i++) {
-    tmp = spec.calc_pdf(x[i] / sig) /
+    tmp = mod.calc_pdf(x[i] / sig) /
           sig;  // must divide by sig because of variable transformation
     out[i] = ((is_log) ? log(tmp) : tmp);
   }
@@ -216,22 +588,21 @@ arma::cube SingleRegime<Model>::f_pdf_its(const NumericVector& theta,
                                           const bool& is_log) {
   // computes volatility
   double sig;
-  spec.loadparam(theta);  // load parameters
-  spec.prep_ineq_vol();   // prepare functions related to volatility
+  Model mod = instance(theta);  // load parameters
   int ny = y.size();
   int nx = x.nrow();
   arma::cube out(nx, ny, 1);
-  volatility vol = spec.set_vol(y[0]);  // initialize volatility
+  volatility vol = mod.set_vol(y[0]);  // initialize volatility
   sig = sqrt(vol.h);
   for (int ix = 0; ix < nx; ix++) {
-    out(ix, 0, 0) = spec_calc_pdf(x(ix, 0) / sig) / sig;  //
+    out(ix, 0, 0) = mod.calc_pdf(x(ix, 0) / sig) / sig;  //
   }
 
   for (int i = 1; i < ny; i++) {
-    spec.increment_vol(vol, y[i - 1]);
+    mod.increment_vol(vol, y[i - 1]);
     sig = sqrt(vol.h);
     for (int ix = 0; ix < nx; ix++) {
-      out(ix, i, 0) = spec_calc_pdf(x(ix, i) / sig) / sig;  //
+      out(ix, i, 0) = mod.calc_pdf(x(ix, i) / sig) / sig;  //
     }
   }
 
@@ -245,11 +616,10 @@ NumericVector SingleRegime<Model>::f_cdf(const NumericVector& x,
                                          const NumericVector& y,
                                          const bool& is_log) {
   // computes volatility
-  spec.loadparam(theta);  // load parameters
-  spec.prep_ineq_vol();   // prepare functions related to volatility
-  volatility vol = spec.set_vol(y[0]);  // initialize volatility
+  Model mod = instance(theta);  // load parameters
+  volatility vol = mod.set_vol(y[0]);  // initialize volatility
   int ny = y.size();
-  for (int t = 0; t < ny; t++) spec.increment_vol(vol, y[t]);
+  for (int t = 0; t < ny; t++) mod.increment_vol(vol, y[t]);
   double sig = sqrt(vol.h);
 
   // computes CDF
@@ -257,7 +627,7 @@ NumericVector SingleRegime<Model>::f_cdf(const NumericVector& x,
   double tmp;
   NumericVector out(nx);
   for (int i = 0; i < nx; i++) {
-    tmp = spec.calc_cdf(x[i] / sig);
+    tmp = mod.calc_cdf(x[i] / sig);
     out[i] = ((is_log) ? log(tmp) : tmp);
   }
   return out;
@@ -270,23 +640,22 @@ arma::cube SingleRegime<Model>::f_cdf_its(const NumericVector& theta,
                                           const bool& is_log) {
   // computes volatility
   double sig;
-  spec.loadparam(theta);  // load parameters
-  spec.prep_ineq_vol();   // prepare functions related to volatility
+  Model mod = instance(theta);  // load parameters
   int ny = y.size();
   int nx = x.nrow();
   arma::cube out(nx, ny, 1);
 
-  volatility vol = spec.set_vol(y[0]);  // initialize volatility
+  volatility vol = mod.set_vol(y[0]);  // initialize volatility
   sig = sqrt(vol.h);
   for (int ix = 0; ix < nx; ix++) {
-    out(ix, 0, 0) = spec.calc_cdf(x(ix, 0) / sig);  //
+    out(ix, 0, 0) = mod.calc_cdf(x(ix, 0) / sig);  //
   }
 
   for (int i = 1; i < ny; i++) {
-    spec.increment_vol(vol, y[i - 1]);
+    mod.increment_vol(vol, y[i - 1]);
     sig = sqrt(vol.h);
     for (int ix = 0; ix < nx; ix++) {
-      out(ix, i, 0) = spec.calc_cdf(x(ix, i) / sig);  //
+      out(ix, i, 0) = mod.calc_cdf(x(ix, i) / sig);  //
     }
   }
 
@@ -299,12 +668,17 @@ template <typename Model>
 NumericVector SingleRegime<Model>::f_rnd(const int& n,
                                          const NumericVector& theta,
                                          const NumericVector& y) {
-  spec.loadparam(theta);  // load parameters
-  spec.prep_ineq_vol();   // prepare functions related to volatility
-  volatility vol = spec.set_vol(y[0]);  // initialize volatility
+  Model mod = instance(theta);  // load parameters
+  volatility vol = mod.set_vol(y[0]);  // initialize volatility
   int ny = y.size();
-  for (int t = 1; t <= ny; t++) spec.increment_vol(vol, y[t - 1]);
-  return sqrt(vol.h) * spec.rndgen(n);
+  for (int t = 1; t <= ny; t++) mod.increment_vol(vol, y[t - 1]);
+  NumericMatrix draws(n, 1), CondVol(n, 1);
+  if (nb_threads() > 1) {
+    sim_parallel(mod, 1, n, &vol, draws, CondVol);
+  } else {
+    sim_serial(mod, 1, n, &vol, draws, CondVol);
+  }
+  return NumericVector(draws.begin(), draws.end());
 }
 
 template <typename Model>
@@ -315,29 +689,44 @@ List SingleRegime<Model>::f_simAhead(const NumericVector& y,
                                               const NumericVector& P0_) {
   // setup
   int nb_obs = y.size();  // total number of observations to simulate
+  Model mod = instance(theta);  // load parameters
+  volatility vol0 = mod.set_vol(y[0]);
+  for (int t = 1; t <= nb_obs; t++) {
+    mod.increment_vol(vol0, y[t - 1]);  // increment all volatilities
+  }
+  return sim_ahead(mod, vol0, n, m);
+}
+
+// same, starting from the volatility of the vector of parameters 'j' of a
+// filter state (see 'f_filter_init')
+template <typename Model>
+List SingleRegime<Model>::f_simAhead_filter(const List& state, const int& j,
+                                            const int& n, const int& m,
+                                            const NumericVector& theta) {
+  NumericMatrix h = state["h"], lnh = state["lnh"], fh = state["fh"];
+  if ((j < 0) || (j >= h.nrow()))
+    stop("the filter state does not match the parameters");
+  Model mod = instance(theta);  // load parameters
+  volatility vol0;
+  vol0.h = h(j, 0), vol0.lnh = lnh(j, 0), vol0.fh = fh(j, 0);
+  return sim_ahead(mod, vol0, n, m);
+}
+
+// 'm' paths of 'n' observations from the one-step-ahead volatility 'vol0'
+template <typename Model>
+List SingleRegime<Model>::sim_ahead(Model& mod, const volatility& vol0,
+                                    const int& n, const int& m) {
   NumericMatrix y_sim(m,n);
   NumericMatrix CondVol(m,n);
-  spec.loadparam(theta);  // load parameters
-  spec.prep_ineq_vol();   // prep for 'set_vol'
-  volatility vol0 = spec.set_vol(y[0]);
-  for (int t = 1; t <= nb_obs; t++) {
-    spec.increment_vol(vol0, y[t - 1]);  // increment all volatilities
-  }
-
-  NumericVector z0 = spec.rndgen(m);  // random innovation from initial state
-  
-  y_sim(_,0) = z0 * sqrt(vol0.h);     // first draw
-  volatility vol = vol0;
-  NumericVector z(n-1);
-  for (int i = 0; i < m; i++) {
-	z = spec.rndgen(n-1);
-	CondVol(i,0) = sqrt(vol.h);
-	for (int t = 1; t < n; t++) {
-		spec.increment_vol(vol, y_sim(i,t - 1));  // increment all volatilities
-		y_sim(i,t) = z[t-1] * sqrt(vol.h);
-		CondVol(i,t) = sqrt(vol.h);
-	}  // new draw
-	vol = vol0;
+  if (sim_method() > 0) {  // variance reduction
+    std::vector<double> u = sim_uniforms(sim_method(), m, n);
+    sim_parallel(mod, n, m, &vol0, y_sim, CondVol, &u[0]);
+    return (List::create(Rcpp::Named("draws") = y_sim, Rcpp::Named("CondVol") = CondVol));
+  }
+  if (nb_threads() > 1) {
+    sim_parallel(mod, n, m, &vol0, y_sim, CondVol);
+  } else {
+    sim_serial(mod, n, m, &vol0, y_sim, CondVol);
   }
   return (List::create(Rcpp::Named("draws") = y_sim, Rcpp::Named("CondVol") = CondVol));
 }
@@ -354,12 +743,11 @@ NumericMatrix SingleRegime<Model>::calc_ht(NumericMatrix& all_thetas,
   NumericMatrix ht(nb_obs + 1, nb_thetas);
   for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
     theta_j = all_thetas(j, _);
-    spec.loadparam(theta_j);
-    spec.prep_ineq_vol();
-    vol = spec.set_vol(y[0]);  // initialize volatility
+    Model mod = instance(theta_j);
+    vol = mod.set_vol(y[0]);  // initialize volatility
     ht(0, j) = vol.h;
     for (int i = 1; i <= nb_obs; i++) {   // loop over observations
-      spec.increment_vol(vol, y[i - 1]);  // increment volatility
+      mod.increment_vol(vol, y[i - 1]);  // increment volatility
       ht(i, j) = vol.h;
     }
   }
@@ -377,9 +765,8 @@ NumericVector SingleRegime<Model>::f_unc_vol(NumericMatrix& all_thetas,
   NumericVector ht(nb_thetas);
   for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
     theta_j = all_thetas(j, _);
-    spec.loadparam(theta_j);
-    spec.prep_ineq_vol();
-    vol = spec.set_vol(y[0]);  // initialize volatility
+    Model mod = instance(theta_j);
+    vol = mod.set_vol(y[0]);  // initialize volatility
     ht(j) = vol.h;
   }
   return ht;
@@ -390,37 +777,332 @@ template <typename Model>
 NumericVector SingleRegime<Model>::eval_model(NumericMatrix& all_thetas,
                                               const NumericVector& y,
                                               const bool& do_prior) {
-  double tmp;
   int nb_obs = y.size();
   int nb_thetas = all_thetas.nrow();
   prior pr;
-  volatility vol;
   NumericVector lnd(nb_thetas);
   NumericVector theta_j;
+  // the instances are built and the priors computed here, by rounds of
+  // 'nb_round' rows whose loglikelihoods are then computed in parallel
+  int nb_thread = std::max(1, nb_threads());
+  int nb_round = 16 * nb_thread;
+  const double* y_ptr = y.begin();
+  std::vector<Model> models(nb_round, spec);
+  std::vector<int> rows(nb_round);
+  std::vector<double> lnd_rows(nb_round);
+  int n = 0;
   for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
     theta_j = all_thetas(j, _);
-    spec.loadparam(theta_j);
-    spec.prep_ineq_vol();
-    pr = calc_prior(theta_j);
+    Model mod = instance(theta_j);  // load parameters
+    pr = calc_prior(mod, theta_j);
     if (do_prior == true) {
       lnd[j] = pr.r2 + pr.r3;
     } else {
       lnd[j] = pr.r2;
     }
     if (pr.r1) {  // if prior satisfied
-      tmp = 0;
-      vol = spec.set_vol(y[0]);  // initialize volatility
-      spec.prep_kernel();
-      for (int i = 1; i < nb_obs; i++) {     // loop over observations
-        spec.increment_vol(vol, y[i - 1]);   // increment volatility
-        tmp += spec.calc_kernel(vol, y[i]);  // increment kernel
-      }
-      lnd[j] += tmp;
+      models[n] = mod;
+      rows[n] = j;
+      n++;
+    }
+    if ((n == nb_round) || ((j == nb_thetas - 1) && (n > 0))) {
+#pragma omp parallel for schedule(dynamic) num_threads(nb_thread)
+      for (int r = 0; r < n; r++)
+        lnd_rows[r] = calc_lnd(models[r], y_ptr, nb_obs);
+      for (int r = 0; r < n; r++) lnd[rows[r]] += lnd_rows[r];
+      n = 0;
     }
   }
   return lnd;
 }
 
+//---------------------- Model gradient ----------------------//
+// loglikelihood (same as 'eval_model') and its gradient with respect to the
+// coefficients, obtained by carrying the derivatives of the volatility along
+// the data: analytic in the coefficients of the model, by central differences
+// of the single steps in those of the distribution (see 'ModelGrad'); rows
+// outside the support of the prior get a null gradient
+template <typename Model>
+List SingleRegime<Model>::eval_model_grad(NumericMatrix& all_thetas,
+                                          const NumericVector& y,
+                                          const bool& do_prior) {
+  int nb_thetas = all_thetas.nrow();
+  int nb_coeffs = spec.nb_coeffs;
+  prior pr;
+  NumericVector lnd(nb_thetas);
+  NumericMatrix grad(nb_thetas, nb_coeffs);
+  NumericVector theta_j;
+  std::vector<double> dlnd(nb_coeffs);
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    Model mod = instance(theta_j);  // load parameters
+    pr = calc_prior(mod, theta_j);
+    if (do_prior == true) {
+      lnd[j] = pr.r2 + pr.r3;
+    } else {
+      lnd[j] = pr.r2;
+    }
+    if (!pr.r1) continue;
+    lnd[j] += calc_lnd_grad(theta_j, y, &dlnd[0], NULL);
+    if (do_prior == true) spec_calc_prior_grad(theta_j, &dlnd[0]);
+    for (int c = 0; c < nb_coeffs; c++) grad(j, c) = dlnd[c];
+  }
+  return List::create(Rcpp::Named("lnd") = lnd, Rcpp::Named("grad") = grad);
+}
+
+// kernel of a single vector of parameters (same as 'eval_model')
+template <typename Model>
+double SingleRegime<Model>::eval_theta(const NumericVector& theta,
+                                       const NumericVector& y,
+                                       const bool& do_prior) {
+  int nb_obs = y.size();
+  Model mod = instance(theta);  // load parameters
+  prior pr = calc_prior(mod, theta);
+  double lnd = ((do_prior == true) ? pr.r2 + pr.r3 : pr.r2);
+  if (!pr.r1) return lnd;
+  return lnd + calc_lnd(mod, y.begin(), nb_obs);
+}
+
+// contributions of each observation to the gradient of the loglikelihood
+// (one row per observation but the first, which is not in the likelihood)
+template <typename Model>
+NumericMatrix SingleRegime<Model>::eval_model_score(const NumericVector& theta,
+                                                    const NumericVector& y) {
+  int nb_obs = y.size();
+  NumericMatrix score(std::max(nb_obs - 1, 0), spec.nb_coeffs);
+  std::vector<double> dlnd(spec.nb_coeffs);
+  calc_lnd_grad(theta, y, &dlnd[0], score.begin());
+  return score;
+}
+
+// loglikelihood of 'theta' and its gradient in 'dlnd'; if 'score' is not
+// null, the contribution of observation 'i' to the derivative 'c' is also
+// stored in 'score[c * (nb_obs - 1) + i - 1]'
+template <typename Model>
+double SingleRegime<Model>::calc_lnd_grad(const NumericVector& theta,
+                                          const NumericVector& y,
+                                          double* dlnd,
+                                          double* score) const {
+  int nb_obs = y.size();
+  int nb_coeffs = spec.nb_coeffs;
+  double lnd = 0;
+  std::vector<double> dh(nb_coeffs), dk(nb_coeffs);
+  std::fill(dlnd, dlnd + nb_coeffs, 0.0);
+  ModelGrad<Model> grad(instance(theta), theta);  // load parameters
+  volatility vol = grad.set_vol_grad(y[0], &dh[0]);  // initialize volatility
+  for (int i = 1; i < nb_obs; i++) {                 // loop over observations
+    grad.increment_vol_grad(vol, &dh[0], y[i - 1]);
+    lnd += grad.calc_kernel_grad(vol, &dh[0], y[i], &dk[0]);
+    for (int c = 0; c < nb_coeffs; c++) dlnd[c] += dk[c];
+    if (score)
+      for (int c = 0; c < nb_coeffs; c++)
+        score[c * (nb_obs - 1) + i - 1] = dk[c];
+  }
+  return lnd;
+}
+
+//---------------------- Filter state ----------------------//
+// the state holds the one-step-ahead volatility ('h', 'lnh' and 'fh') and
+// the loglikelihood 'LL' of the observations (but the first) of each vector
+// of parameters; 'Pspot' and 'PredProb' are those of a single regime
+template <typename Model>
+List SingleRegime<Model>::f_filter_init(NumericMatrix& all_thetas,
+                                        const NumericVector& y) {
+  int nb_obs = y.size();
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix h(nb_thetas, 1), lnh(nb_thetas, 1), fh(nb_thetas, 1);
+  NumericVector LL(nb_thetas);
+  NumericVector theta_j;
+  if (nb_obs == 0) stop("y is empty");
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    Model mod = instance(theta_j);
+    volatility vol = mod.set_vol(y[0]);  // initialize volatility
+    double tmp = 0;
+    mod.increment_vol(vol, y[0]);
+    for (int i = 1; i < nb_obs; i++) {  // loop over observations
+      tmp += mod.calc_kernel(vol, y[i]);
+      mod.increment_vol(vol, y[i]);
+    }
+    h(j, 0) = vol.h, lnh(j, 0) = vol.lnh, fh(j, 0) = vol.fh;
+    LL[j] = tmp;
+  }
+  NumericMatrix P(nb_thetas, 1);
+  P.fill(1.0);
+  return List::create(Rcpp::Named("h") = h, Rcpp::Named("lnh") = lnh,
+                      Rcpp::Named("fh") = fh, Rcpp::Named("Pspot") = P,
+                      Rcpp::Named("PredProb") = Rcpp::clone(P),
+                      Rcpp::Named("LL") = LL);
+}
+
+// O(1) per observation and vector of parameters: the volatility is advanced
+// from the stored state, not from the start of the data
+template <typename Model>
+List SingleRegime<Model>::f_filter_update(NumericMatrix& all_thetas,
+                                          const List& state,
+                                          const NumericVector& y) {
+  int nb_obs = y.size();
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix h = Rcpp::clone(as<NumericMatrix>(state["h"]));
+  NumericMatrix lnh = Rcpp::clone(as<NumericMatrix>(state["lnh"]));
+  NumericMatrix fh = Rcpp::clone(as<NumericMatrix>(state["fh"]));
+  NumericVector LL = Rcpp::clone(as<NumericVector>(state["LL"]));
+  NumericVector theta_j;
+  if ((h.nrow() != nb_thetas) || (LL.size() != nb_thetas))
+    stop("the filter state does not match the parameters");
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    Model mod = instance(theta_j);
+    volatility vol;
+    vol.h = h(j, 0), vol.lnh = lnh(j, 0), vol.fh = fh(j, 0);
+    for (int i = 0; i < nb_obs; i++) {  // loop over new observations
+      LL[j] += mod.calc_kernel(vol, y[i]);
+      mod.increment_vol(vol, y[i]);
+    }
+    h(j, 0) = vol.h, lnh(j, 0) = vol.lnh, fh(j, 0) = vol.fh;
+  }
+  return List::create(Rcpp::Named("h") = h, Rcpp::Named("lnh") = lnh,
+                      Rcpp::Named("fh") = fh, Rcpp::Named("Pspot") = state["Pspot"],
+                      Rcpp::Named("PredProb") = state["PredProb"],
+                      Rcpp::Named("LL") = LL);
+}
+
+//---------------------- Variance forecasts ----------------------//
+// expected variance of the observations 1 to 'n_ahead' steps after 'y' (one
+// column per vector of parameters): the one-step-ahead variance follows
+// 'h_{t+1} = c[0] + (c[1] + c[2] c[4] + c[3]) h_t' in expectation (see
+// 'forecast_coeffs'); NA when the model has no closed form
+template <typename Model>
+NumericMatrix SingleRegime<Model>::f_forecast_var(NumericMatrix& all_thetas,
+                                                  const NumericVector& y,
+                                                  const int& n_ahead) {
+  return f_forecast_var_filter(all_thetas, f_filter_init(all_thetas, y),
+                               n_ahead);
+}
+
+template <typename Model>
+NumericMatrix SingleRegime<Model>::f_forecast_var_filter(
+    NumericMatrix& all_thetas, const List& state, const int& n_ahead) {
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix out(n_ahead, nb_thetas);
+  NumericMatrix h = state["h"];
+  NumericVector theta_j;
+  if (h.nrow() != nb_thetas)
+    stop("the filter state does not match the parameters");
+  double c[5];
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    Model mod = instance(theta_j);
+    if (!mod.forecast_coeffs(c)) {
+      std::fill(out.begin(), out.end(), NA_REAL);
+      return out;
+    }
+    double ht = h(j, 0), persistence = c[1] + c[2] * c[4] + c[3];
+    for (int t = 0; t < n_ahead; t++) {
+      if (t > 0) ht = c[0] + persistence * ht;
+      out(t, j) = ht;
+    }
+  }
+  return out;
+}
+
+//---------------------- Predictive distribution ----------------------//
+// PDF (or, if 'do_cdf', CDF) at 'x' of the predictive distribution one step
+// after a filter state, averaged over the vectors of parameters
+template <typename Model>
+NumericVector SingleRegime<Model>::f_pred_filter(const NumericVector& x,
+                                                 NumericMatrix& all_thetas,
+                                                 const List& state,
+                                                 const bool& do_cdf) {
+  int nx = x.size();
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix h = state["h"];
+  if (h.nrow() != nb_thetas)
+    stop("the filter state does not match the parameters");
+  NumericVector out(nx);
+  NumericVector theta_j;
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    Model mod = instance(theta_j);
+    double sig = sqrt(h(j, 0));
+    for (int i = 0; i < nx; i++)
+      out[i] += ((do_cdf) ? mod.calc_cdf(x[i] / sig)
+                          : mod.calc_pdf(x[i] / sig) / sig) / nb_thetas;
+  }
+  return out;
+}
+
+//---------------------- Risk measures ----------------------//
+// Value-at-Risk and Expected-shortfall at the levels 'alpha' of the
+// predictive distribution after 'y' (or, if 'do_its', at each observation
+// given the previous ones), the mixture over the vectors of parameters being
+// solved for directly (see 'RiskMixture'); returns the matrices 'VaR' and
+// 'ES' (NA if not 'do_es') with one row per date and one column per level.
+// The volatilities of all the vectors of parameters are advanced together in
+// a single pass over the data (on instances of the model), so that only the
+// current ones are stored
+template <typename Model>
+List SingleRegime<Model>::f_risk(NumericMatrix& all_thetas,
+                                 const NumericVector& y,
+                                 const NumericVector& alpha, const bool& do_its,
+                                 const bool& do_es) {
+  int nb_obs = y.size();
+  int nb_thetas = all_thetas.nrow();
+  if (nb_obs == 0) stop("y is empty");
+  std::vector<Base*> models(nb_thetas);
+  std::vector<volatility> vol(nb_thetas);
+  NumericVector theta_j;
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    models[j] = clone_instance(theta_j);
+    vol[j] = models[j]->spec_set_vol(y[0]);
+  }
+  NumericMatrix VaR((do_its) ? nb_obs : 1, alpha.size());
+  NumericMatrix ES((do_its) ? nb_obs : 1, alpha.size());
+  if (!do_es) std::fill(ES.begin(), ES.end(), NA_REAL);
+  int nb_na = 0;
+  for (int i = 0; i <= nb_obs; i++) {  // 'nb_obs': one step after the data
+    if (i > 0)
+      for (int j = 0; j < nb_thetas; j++)
+        models[j]->spec_increment_vol(vol[j], y[i - 1]);
+    if ((do_its) ? (i == nb_obs) : (i < nb_obs)) continue;
+    RiskMixture mix;
+    for (int j = 0; j < nb_thetas; j++)
+      mix.add(models[j], 1.0 / nb_thetas, sqrt(vol[j].h));
+    nb_na += mix.risk(alpha, do_es, ((do_its) ? i : 0), VaR, ES);
+  }
+  for (int j = 0; j < nb_thetas; j++) delete models[j];
+  risk_warning(nb_na);
+  return List::create(Rcpp::Named("VaR") = VaR, Rcpp::Named("ES") = ES);
+}
+
+// the one-step-ahead volatilities are those of the filter state, so that the
+// data need not be processed again (e.g. between the refits of a backtest)
+template <typename Model>
+List SingleRegime<Model>::f_risk_filter(NumericMatrix& all_thetas,
+                                        const List& state,
+                                        const NumericVector& alpha,
+                                        const bool& do_es) {
+  int nb_thetas = all_thetas.nrow();
+  NumericMatrix h = state["h"];
+  if (h.nrow() != nb_thetas)
+    stop("the filter state does not match the parameters");
+  std::vector<Base*> models(nb_thetas);
+  RiskMixture mix;
+  NumericVector theta_j;
+  for (int j = 0; j < nb_thetas; j++) {  // loop over vectors of parameters
+    theta_j = all_thetas(j, _);
+    models[j] = clone_instance(theta_j);
+    mix.add(models[j], 1.0 / nb_thetas, sqrt(h(j, 0)));
+  }
+  NumericMatrix VaR(1, alpha.size()), ES(1, alpha.size());
+  if (!do_es) std::fill(ES.begin(), ES.end(), NA_REAL);
+  int nb_na = mix.risk(alpha, do_es, 0, VaR, ES);
+  for (int j = 0; j < nb_thetas; j++) delete models[j];
+  risk_warning(nb_na);
+  return List::create(Rcpp::Named("VaR") = VaR, Rcpp::Named("ES") = ES);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 //==================================== CLASS DEFINITIONS
 //========================================//
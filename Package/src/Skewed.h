@@ -3,6 +3,7 @@
 
 #include <RcppArmadillo.h>
 #include "Utils.h"
+#include "Rng.h"
 using namespace Rcpp;
 
 template <typename underlying>
@@ -105,6 +106,32 @@ class Skewed {
     return lncst + f1.kernel(vol, yi_xi);
   }
 
+  // kernels of the "n" observations "y" with variances "h" (and their
+  // logarithms "lnh"), in "out" ("n" at most KERNEL_BLOCK_SIZE)
+  void calc_kernel_block(const double* h, const double* lnh, const double* y,
+                         double* out, const int& n) {
+    double y_xi[KERNEL_BLOCK_SIZE];
+#pragma omp simd
+    for (int i = 0; i < n; i++) {
+      double sig = sqrt(h[i]);
+      y_xi[i] = ((y[i] >= sig * cutoff) ? 1 / xi : xi) *
+                (sig_xi * y[i] + sig * mu_xi);
+    }
+    f1.kernel_block(h, lnh, y_xi, out, n);
+#pragma omp simd
+    for (int i = 0; i < n; i++) out[i] += lncst;
+  }
+
+  // derivative of "calc_kernel" with respect to the variance (through "vol"
+  // and through the transformed observation)
+  double calc_kernel_dh(const volatility& vol, const double& yi) {
+    double sig = sqrt(vol.h);
+    double c = ((yi >= sig * cutoff) ? 1 / xi : xi);
+    double yi_xi = c * (sig_xi * yi + sig * mu_xi);
+    return f1.kernel_dh(vol, yi_xi) +
+           f1.kernel_dy(vol, yi_xi) * c * mu_xi / (2 * sig);
+  }
+
   double calc_pdf(const double& x) {
     prep_kernel();
     volatility unit;
@@ -156,29 +183,55 @@ class Skewed {
                          (0.5 - 0.5 * M1_2 * (1 - xi4) - intgrl_2));
   }
 
-  // returns a random vector of length "n"
+  // returns a random vector of length "n" (see "rnd_method"); the direct
+  // draw is the one of the symmetric distribution, in absolute value, on
+  // the negative side with probability "pcut"
   NumericVector rndgen(const int& n) {
     NumericVector out(n);
-    NumericVector u = runif(n, 0, 1);
-    for (int i = 0; i < n; i++)
-      out[i] =
-          ((u[i] < pcut)
-               ? (f1.invsample(0.5 * u[i] * (xi2 + 1)) / xi - mu_xi) / sig_xi
-               : (f1.invsample(0.5 * u[i] * (1 + 1 / xi2) - 0.5 / xi2 + 0.5) *
-                      xi -
-                  mu_xi) /
-                     sig_xi);
+    RRng gen;
+    prep_rnd();
+    for (int i = 0; i < n; i++) out[i] = draw(gen, rnd_method());
     return out;
   }
+  // draw from the generator "gen" by the method "method" (see "rnd_method";
+  // with 2, the table must be ready, see "prep_table")
+  template <typename Gen>
+  double draw(Gen& gen, const int& method) {
+    if (method == 1) {
+      double w = fabs(f1.rnd_direct(gen));
+      return (((gen.unif() < pcut) ? -w / xi : w * xi) - mu_xi) / sig_xi;
+    }
+    return skew_invsample(gen.unif(), (method == 2));
+  }
+  // inverse transform, with the table of quantiles if "rnd_method" is 2 (the
+  // table must then be ready, see "prep_rnd")
   double calc_invsample(const double& x) {
+    return skew_invsample(x, (rnd_method() == 2));
+  }
+  // same, with the table of quantiles whatever "rnd_method", free of the R
+  // API for the worker threads (the table must be ready, see "prep_table")
+  double calc_invsample_table(const double& x) {
+    return skew_invsample(x, true);
+  }
+  double skew_invsample(const double& x, const bool& do_table) {
     double out =
         ((x < pcut)
-             ? (f1.invsample(0.5 * x * (xi2 + 1)) / xi - mu_xi) / sig_xi
-             : (f1.invsample(0.5 * x * (1 + 1 / xi2) - 0.5 / xi2 + 0.5) * xi -
+             ? (f1_invsample(0.5 * x * (xi2 + 1), do_table) / xi - mu_xi) /
+                   sig_xi
+             : (f1_invsample(0.5 * x * (1 + 1 / xi2) - 0.5 / xi2 + 0.5,
+                             do_table) *
+                    xi -
                 mu_xi) /
                    sig_xi);
     return (out);
   }
+  double f1_invsample(const double& x, const bool& do_table) {
+    return ((do_table) ? f1.invsample_table(x) : f1.invsample(x));
+  }
+  void prep_rnd() {
+    if (rnd_method() == 2) f1.prep_table();
+  }
+  void prep_table() { f1.prep_table(); }
 };
 
 #endif  // Skewed.h
\ No newline at end of file
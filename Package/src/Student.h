@@ -12,6 +12,7 @@ class Student {
   double lncst;  // constant term in "kernel"
   double cst;    // constant term in "PDF"
   double P;  // factor to standardize R's definition of Student-t distribution
+  std::shared_ptr<const QuantileTable> table;  // quantiles for "nu"
  public:
   double M1;  // E[|z|]
 
@@ -64,6 +65,28 @@ class Student {
            0.5 * (nu + 1) * log(vol.h * (nu - 2) + pow(yi, 2));
   }
 
+  // same as "kernel" for the "n" observations "y" with variances "h" (and
+  // their logarithms "lnh"), in "out" ("n" at most KERNEL_BLOCK_SIZE)
+  void kernel_block(const double* h, const double* lnh, const double* y,
+                    double* out, const int& n) {
+    double tmp[KERNEL_BLOCK_SIZE];
+#pragma omp simd
+    for (int i = 0; i < n; i++) tmp[i] = h[i] * (nu - 2) + y[i] * y[i];
+    vec_log(tmp, out, n);
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+      out[i] = lncst + 0.5 * nu * lnh[i] - 0.5 * (nu + 1) * out[i];
+  }
+
+  // derivatives of "kernel" with respect to the variance and the observation
+  double kernel_dh(const volatility& vol, const double& yi) {
+    return 0.5 * nu / vol.h -
+           0.5 * (nu + 1) * (nu - 2) / (vol.h * (nu - 2) + pow(yi, 2));
+  }
+  double kernel_dy(const volatility& vol, const double& yi) {
+    return -(nu + 1) * yi / (vol.h * (nu - 2) + pow(yi, 2));
+  }
+
   double pdf(const double& x) {
     prep_kernel();
     volatility unit;
@@ -79,6 +102,23 @@ class Student {
 
   // applies inverse transform sampling on a Uniform(0,1) draw
   double invsample(const double& u) { return R::qt(u, nu, 1, 0) / P; }
+
+  // direct draw from the generator "gen" (see "RRng" and "Xoshiro"): ratio
+  // of a standard normal and of the square root of an independent chi-square
+  // (twice a gamma of shape nu / 2) divided by its degrees of freedom
+  template <typename Gen>
+  double rnd_direct(Gen& gen) {
+    double z = gen.norm();
+    double chi2 = 2 * gen.gamma(0.5 * nu);
+    return z / sqrt(chi2 / nu) / P;
+  }
+
+  // inverse transform with the table of quantiles (must call "prep_table"
+  // first, on the main thread; "invsample_table" is free of the R API)
+  void prep_table() {
+    if (!table || table->par != nu) table = quantile_table(*this, nu);
+  }
+  double invsample_table(const double& u) { return table->get(u); }
 };
 
 #endif  // Student.h
\ No newline at end of file
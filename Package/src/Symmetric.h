@@ -3,6 +3,7 @@
 
 #include <RcppArmadillo.h>
 #include "Utils.h"
+#include "Rng.h"
 using namespace Rcpp;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -46,6 +47,18 @@ class Symmetric {
     return f1.kernel(vol, yi);  // if in A (log density);  // if not
   }
 
+  // kernels of the "n" observations "y" with variances "h" (and their
+  // logarithms "lnh"), in "out" ("n" at most KERNEL_BLOCK_SIZE)
+  void calc_kernel_block(const double* h, const double* lnh, const double* y,
+                         double* out, const int& n) {
+    f1.kernel_block(h, lnh, y, out, n);
+  }
+
+  // derivative of "calc_kernel" with respect to the variance
+  double calc_kernel_dh(const volatility& vol, const double& yi) {
+    return f1.kernel_dh(vol, yi);
+  }
+
   double calc_pdf(const double& x) {
     prep_kernel();
     volatility unit;
@@ -68,15 +81,38 @@ class Symmetric {
     Ez2Ineg = 0.5;
   }  // = E[z^2 * I(z<0)] = Prob(z < 0) * E[z^2 | z < 0]
 
-  // returns a random vector of length "n"
+  // returns a random vector of length "n" (see "rnd_method")
   NumericVector rndgen(const int& n) {
     NumericVector out(n);
-    NumericVector u = runif(n, 0, 1);
-    for (int i = 0; i < n; i++) out[i] = f1.invsample(u[i]);
+    RRng gen;
+    prep_rnd();
+    for (int i = 0; i < n; i++) out[i] = draw(gen, rnd_method());
     return out;
   }
+  // draw from the generator "gen" by the method "method" (see "rnd_method";
+  // with 2, the table must be ready, see "prep_table")
+  template <typename Gen>
+  double draw(Gen& gen, const int& method) {
+    if (method == 1) return f1.rnd_direct(gen);
+    double u = gen.unif();
+    return ((method == 2) ? f1.invsample_table(u) : f1.invsample(u));
+  }
 
-  double calc_invsample(const double& x) { return (f1.invsample(x)); }
+  // inverse transform, with the table of quantiles if "rnd_method" is 2 (the
+  // table must then be ready, see "prep_rnd")
+  double calc_invsample(const double& x) {
+    return ((rnd_method() == 2) ? f1.invsample_table(x) : f1.invsample(x));
+  }
+  void prep_rnd() {
+    if (rnd_method() == 2) f1.prep_table();
+  }
+  // inverse transform with the table of quantiles whatever "rnd_method", free
+  // of the R API for the worker threads (the table must be ready, see
+  // "prep_table")
+  double calc_invsample_table(const double& x) {
+    return f1.invsample_table(x);
+  }
+  void prep_table() { f1.prep_table(); }
 };
 
 #endif  // Symmetric.h
\ No newline at end of file
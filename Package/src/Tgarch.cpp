@@ -38,6 +38,7 @@ RCPP_MODULE(tGARCH) {
       .method("f_cdf", &tGARCH_norm::f_cdf)
       .method("f_cdf_its", &tGARCH_norm::f_cdf_its)
       .method("f_simAhead", &tGARCH_norm::f_simAhead)
+      .method("f_simAhead_filter", &tGARCH_norm::f_simAhead_filter)
       .method("f_get_sd", &tGARCH_norm::get_sd)
       .method("f_set_sd", &tGARCH_norm::set_sd)
       .method("f_get_mean", &tGARCH_norm::get_mean)
@@ -45,6 +46,17 @@ RCPP_MODULE(tGARCH) {
       .method("f_rnd", &tGARCH_norm::f_rnd)
       .method("calc_ht", &tGARCH_norm::calc_ht)
       .method("eval_model", &tGARCH_norm::eval_model)
+      .method("eval_model_grad", &tGARCH_norm::eval_model_grad)
+      .method("eval_model_score", &tGARCH_norm::eval_model_score)
+      .method("f_mcmc", &tGARCH_norm::f_mcmc)
+      .method("f_mcmc_chains", &tGARCH_norm::f_mcmc_chains)
+      .method("f_filter_init", &tGARCH_norm::f_filter_init)
+      .method("f_filter_update", &tGARCH_norm::f_filter_update)
+      .method("f_forecast_var", &tGARCH_norm::f_forecast_var)
+      .method("f_forecast_var_filter", &tGARCH_norm::f_forecast_var_filter)
+      .method("f_pred_filter", &tGARCH_norm::f_pred_filter)
+      .method("f_risk", &tGARCH_norm::f_risk)
+      .method("f_risk_filter", &tGARCH_norm::f_risk_filter)
       .method("ineq_func", &tGARCH_norm::ineq_func)
       .method("f_unc_vol", &tGARCH_norm::f_unc_vol);
   // tGARCH-std-symmetric
@@ -66,6 +78,7 @@ RCPP_MODULE(tGARCH) {
       .method("f_cdf", &tGARCH_std::f_cdf)
       .method("f_cdf_its", &tGARCH_std::f_cdf_its)
       .method("f_simAhead", &tGARCH_std::f_simAhead)
+      .method("f_simAhead_filter", &tGARCH_std::f_simAhead_filter)
       .method("f_get_sd", &tGARCH_std::get_sd)
       .method("f_set_sd", &tGARCH_std::set_sd)
       .method("f_get_mean", &tGARCH_std::get_mean)
@@ -73,6 +86,17 @@ RCPP_MODULE(tGARCH) {
       .method("f_rnd", &tGARCH_std::f_rnd)
       .method("calc_ht", &tGARCH_std::calc_ht)
       .method("eval_model", &tGARCH_std::eval_model)
+      .method("eval_model_grad", &tGARCH_std::eval_model_grad)
+      .method("eval_model_score", &tGARCH_std::eval_model_score)
+      .method("f_mcmc", &tGARCH_std::f_mcmc)
+      .method("f_mcmc_chains", &tGARCH_std::f_mcmc_chains)
+      .method("f_filter_init", &tGARCH_std::f_filter_init)
+      .method("f_filter_update", &tGARCH_std::f_filter_update)
+      .method("f_forecast_var", &tGARCH_std::f_forecast_var)
+      .method("f_forecast_var_filter", &tGARCH_std::f_forecast_var_filter)
+      .method("f_pred_filter", &tGARCH_std::f_pred_filter)
+      .method("f_risk", &tGARCH_std::f_risk)
+      .method("f_risk_filter", &tGARCH_std::f_risk_filter)
       .method("ineq_func", &tGARCH_std::ineq_func)
       .method("f_unc_vol", &tGARCH_std::f_unc_vol);
   // tGARCH-ged-symmetric
@@ -94,6 +118,7 @@ RCPP_MODULE(tGARCH) {
       .method("f_cdf", &tGARCH_ged::f_cdf)
       .method("f_cdf_its", &tGARCH_ged::f_cdf_its)
       .method("f_simAhead", &tGARCH_ged::f_simAhead)
+      .method("f_simAhead_filter", &tGARCH_ged::f_simAhead_filter)
       .method("f_get_sd", &tGARCH_ged::get_sd)
       .method("f_set_sd", &tGARCH_ged::set_sd)
       .method("f_get_mean", &tGARCH_ged::get_mean)
@@ -101,6 +126,17 @@ RCPP_MODULE(tGARCH) {
       .method("f_rnd", &tGARCH_ged::f_rnd)
       .method("calc_ht", &tGARCH_ged::calc_ht)
       .method("eval_model", &tGARCH_ged::eval_model)
+      .method("eval_model_grad", &tGARCH_ged::eval_model_grad)
+      .method("eval_model_score", &tGARCH_ged::eval_model_score)
+      .method("f_mcmc", &tGARCH_ged::f_mcmc)
+      .method("f_mcmc_chains", &tGARCH_ged::f_mcmc_chains)
+      .method("f_filter_init", &tGARCH_ged::f_filter_init)
+      .method("f_filter_update", &tGARCH_ged::f_filter_update)
+      .method("f_forecast_var", &tGARCH_ged::f_forecast_var)
+      .method("f_forecast_var_filter", &tGARCH_ged::f_forecast_var_filter)
+      .method("f_pred_filter", &tGARCH_ged::f_pred_filter)
+      .method("f_risk", &tGARCH_ged::f_risk)
+      .method("f_risk_filter", &tGARCH_ged::f_risk_filter)
       .method("ineq_func", &tGARCH_ged::ineq_func)
       .method("f_unc_vol", &tGARCH_ged::f_unc_vol);
 
@@ -123,6 +159,7 @@ RCPP_MODULE(tGARCH) {
       .method("f_cdf", &tGARCH_snorm::f_cdf)
       .method("f_cdf_its", &tGARCH_snorm::f_cdf_its)
       .method("f_simAhead", &tGARCH_snorm::f_simAhead)
+      .method("f_simAhead_filter", &tGARCH_snorm::f_simAhead_filter)
       .method("f_get_sd", &tGARCH_snorm::get_sd)
       .method("f_set_sd", &tGARCH_snorm::set_sd)
       .method("f_get_mean", &tGARCH_snorm::get_mean)
@@ -130,6 +167,17 @@ RCPP_MODULE(tGARCH) {
       .method("f_rnd", &tGARCH_snorm::f_rnd)
       .method("calc_ht", &tGARCH_snorm::calc_ht)
       .method("eval_model", &tGARCH_snorm::eval_model)
+      .method("eval_model_grad", &tGARCH_snorm::eval_model_grad)
+      .method("eval_model_score", &tGARCH_snorm::eval_model_score)
+      .method("f_mcmc", &tGARCH_snorm::f_mcmc)
+      .method("f_mcmc_chains", &tGARCH_snorm::f_mcmc_chains)
+      .method("f_filter_init", &tGARCH_snorm::f_filter_init)
+      .method("f_filter_update", &tGARCH_snorm::f_filter_update)
+      .method("f_forecast_var", &tGARCH_snorm::f_forecast_var)
+      .method("f_forecast_var_filter", &tGARCH_snorm::f_forecast_var_filter)
+      .method("f_pred_filter", &tGARCH_snorm::f_pred_filter)
+      .method("f_risk", &tGARCH_snorm::f_risk)
+      .method("f_risk_filter", &tGARCH_snorm::f_risk_filter)
       .method("ineq_func", &tGARCH_snorm::ineq_func)
       .method("f_unc_vol", &tGARCH_snorm::f_unc_vol);
   // tGARCH-std-skew
@@ -151,6 +199,7 @@ RCPP_MODULE(tGARCH) {
       .method("f_cdf", &tGARCH_sstd::f_cdf)
       .method("f_cdf_its", &tGARCH_sstd::f_cdf_its)
       .method("f_simAhead", &tGARCH_sstd::f_simAhead)
+      .method("f_simAhead_filter", &tGARCH_sstd::f_simAhead_filter)
       .method("f_get_sd", &tGARCH_sstd::get_sd)
       .method("f_set_sd", &tGARCH_sstd::set_sd)
       .method("f_get_mean", &tGARCH_sstd::get_mean)
@@ -158,6 +207,17 @@ RCPP_MODULE(tGARCH) {
       .method("f_rnd", &tGARCH_sstd::f_rnd)
       .method("calc_ht", &tGARCH_sstd::calc_ht)
       .method("eval_model", &tGARCH_sstd::eval_model)
+      .method("eval_model_grad", &tGARCH_sstd::eval_model_grad)
+      .method("eval_model_score", &tGARCH_sstd::eval_model_score)
+      .method("f_mcmc", &tGARCH_sstd::f_mcmc)
+      .method("f_mcmc_chains", &tGARCH_sstd::f_mcmc_chains)
+      .method("f_filter_init", &tGARCH_sstd::f_filter_init)
+      .method("f_filter_update", &tGARCH_sstd::f_filter_update)
+      .method("f_forecast_var", &tGARCH_sstd::f_forecast_var)
+      .method("f_forecast_var_filter", &tGARCH_sstd::f_forecast_var_filter)
+      .method("f_pred_filter", &tGARCH_sstd::f_pred_filter)
+      .method("f_risk", &tGARCH_sstd::f_risk)
+      .method("f_risk_filter", &tGARCH_sstd::f_risk_filter)
       .method("ineq_func", &tGARCH_sstd::ineq_func)
       .method("f_unc_vol", &tGARCH_sstd::f_unc_vol);
   // tGARCH-ged-skew
@@ -179,6 +239,7 @@ RCPP_MODULE(tGARCH) {
       .method("f_cdf", &tGARCH_sged::f_cdf)
       .method("f_cdf_its", &tGARCH_sged::f_cdf_its)
       .method("f_simAhead", &tGARCH_sged::f_simAhead)
+      .method("f_simAhead_filter", &tGARCH_sged::f_simAhead_filter)
       .method("f_get_sd", &tGARCH_sged::get_sd)
       .method("f_set_sd", &tGARCH_sged::set_sd)
       .method("f_get_mean", &tGARCH_sged::get_mean)
@@ -186,6 +247,17 @@ RCPP_MODULE(tGARCH) {
       .method("f_rnd", &tGARCH_sged::f_rnd)
       .method("calc_ht", &tGARCH_sged::calc_ht)
       .method("eval_model", &tGARCH_sged::eval_model)
+      .method("eval_model_grad", &tGARCH_sged::eval_model_grad)
+      .method("eval_model_score", &tGARCH_sged::eval_model_score)
+      .method("f_mcmc", &tGARCH_sged::f_mcmc)
+      .method("f_mcmc_chains", &tGARCH_sged::f_mcmc_chains)
+      .method("f_filter_init", &tGARCH_sged::f_filter_init)
+      .method("f_filter_update", &tGARCH_sged::f_filter_update)
+      .method("f_forecast_var", &tGARCH_sged::f_forecast_var)
+      .method("f_forecast_var_filter", &tGARCH_sged::f_forecast_var_filter)
+      .method("f_pred_filter", &tGARCH_sged::f_pred_filter)
+      .method("f_risk", &tGARCH_sged::f_risk)
+      .method("f_risk_filter", &tGARCH_sged::f_risk_filter)
       .method("ineq_func", &tGARCH_sged::ineq_func)
       .method("f_unc_vol", &tGARCH_sged::f_unc_vol);
 }
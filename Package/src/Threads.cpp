@@ -0,0 +1,20 @@
+#include <RcppArmadillo.h>
+#include "Utils.h"
+
+using namespace Rcpp;
+
+// sets the number of threads of the parallel loops ('n' < 1 for all the
+// available cores) and returns the previous one
+// [[Rcpp::export]]
+int set_nb_threads(const int& n) {
+  int nb_old = nb_threads();
+#ifdef _OPENMP
+  nb_threads() = ((n < 1) ? omp_get_num_procs() : n);
+#else
+  nb_threads() = 1;  // compiled without OpenMP
+#endif
+  return nb_old;
+}
+
+// [[Rcpp::export]]
+int get_nb_threads() { return nb_threads(); }
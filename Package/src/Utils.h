@@ -2,6 +2,12 @@
 #define UTILS_H
 
 #include <RcppArmadillo.h>
+#include <stdint.h>
+#include <cstring>
+#include <memory>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 using namespace Rcpp;
 
 typedef std::pair<double, double> pair;
@@ -11,6 +17,9 @@ struct volatility {
   double lnh;  // log(h)
   double fh;   // some arbitraty function of "h" (e.g. sqrt(h) as in the Tgarch
                // model)
+  // zero-initialised, so that a model not using "fh" still stores (and
+  // restores, see 'f_filter_init') a defined value
+  volatility() : h(0), lnh(0), fh(0) {}
 };
 
 struct prior {
@@ -29,35 +38,174 @@ inline bool IsInfNan(const double& x) {
 
 // Auxiliary function for adaptive Simpson's Rule:
 // https://en.wikipedia.org/wiki/Adaptive_Simpson%27s_method
+// ('*converged' is set to false when a subinterval reaches the recursion
+// cap before the tolerance)
 template <typename C>
 double adaptiveSimpsonsAux(double (C::*f)(const double&), C* pf, double a,
                            double b, double epsilon, double S, double fa,
-                           double fb, double fc, int bottom) {
+                           double fb, double fc, int bottom, bool* converged) {
   double c = (a + b) / 2, h = b - a;
   double d = (a + c) / 2, e = (c + b) / 2;
   double fd = (pf->*f)(d), fe = (pf->*f)(e);
   double Sleft = (h / 12) * (fa + 4 * fd + fc);
   double Sright = (h / 12) * (fc + 4 * fe + fb);
   double S2 = Sleft + Sright;
-  if (bottom <= 100 || fabs(S2 - S) / (1e-10 + fabs(S2)) <= epsilon ||
-      IsInfNan(S2))
+  if (fabs(S2 - S) / (1e-10 + fabs(S2)) <= epsilon) return S2 + (S2 - S) / 8;
+  if (bottom <= 0 || IsInfNan(S2)) {
+    *converged = false;
     return S2 + (S2 - S) / 8;
+  }
   return adaptiveSimpsonsAux(f, pf, a, c, epsilon, Sleft, fa, fc, fd,
-                             bottom - 1) +
+                             bottom - 1, converged) +
          adaptiveSimpsonsAux(f, pf, c, b, epsilon, Sright, fc, fb, fe,
-                             bottom - 1);
+                             bottom - 1, converged);
 }
 
 // Adaptive Simpson's Rule in integrate in interval [a, b]
 // https://en.wikipedia.org/wiki/Adaptive_Simpson%27s_method
+// ('converged', if not null, tells whether the tolerance was reached in
+// every subinterval within 'maxRecursion' halvings)
 template <typename C>
 double adaptiveSimpsons(
     double (C::*f)(const double&), C* pf, double a, double b, double epsilon,
-    int maxRecursion) {  // error tolerance and recursion cap
+    int maxRecursion, bool* converged = NULL) {  // error tolerance and recursion cap
   double c = (a + b) / 2, h = b - a;
   double fa = (pf->*f)(a), fb = (pf->*f)(b), fc = (pf->*f)(c);
   double S = (h / 6) * (fa + 4 * fc + fb);
-  return adaptiveSimpsonsAux(f, pf, a, b, epsilon, S, fa, fb, fc, maxRecursion);
+  bool ok = true;
+  double out = adaptiveSimpsonsAux(f, pf, a, b, epsilon, S, fa, fb, fc,
+                                   maxRecursion, &ok);
+  if (converged) *converged = ok;
+  return out;
+}
+
+// Brent's method for the root of 'f' in [a, b], where 'f(a)' and 'f(b)' have
+// opposite signs: https://en.wikipedia.org/wiki/Brent%27s_method
+template <typename C>
+double brentRoot(double (C::*f)(const double&), C* pf, double a, double b,
+                 double tol, int maxIter) {
+  double fa = (pf->*f)(a), fb = (pf->*f)(b);
+  if (fa == 0) return a;
+  if (fb == 0) return b;
+  double c = a, fc = fa, d = b - a, e = d;
+  for (int i = 0; i < maxIter; i++) {
+    if ((fb > 0) == (fc > 0)) c = a, fc = fa, d = e = b - a;
+    if (fabs(fc) < fabs(fb)) {  // 'b' is the best estimate
+      a = b, b = c, c = a;
+      fa = fb, fb = fc, fc = fa;
+    }
+    double tol1 = 2 * DBL_EPSILON * fabs(b) + 0.5 * tol, m = 0.5 * (c - b);
+    if (fabs(m) <= tol1 || fb == 0) return b;
+    if (fabs(e) >= tol1 && fabs(fa) > fabs(fb)) {  // interpolation
+      double p, q, r, s = fb / fa;
+      if (a == c) {
+        p = 2 * m * s, q = 1 - s;
+      } else {
+        q = fa / fc, r = fb / fc;
+        p = s * (2 * m * q * (q - r) - (b - a) * (r - 1));
+        q = (q - 1) * (r - 1) * (s - 1);
+      }
+      if (p > 0) q = -q;
+      p = fabs(p);
+      if (2 * p < std::min(3 * m * q - fabs(tol1 * q), fabs(e * q))) {
+        e = d, d = p / q;
+      } else {
+        d = m, e = m;  // bisection
+      }
+    } else {
+      d = m, e = m;  // bisection
+    }
+    a = b, fa = fb;
+    b += ((fabs(d) > tol1) ? d : ((m > 0) ? tol1 : -tol1));
+    fb = (pf->*f)(b);
+  }
+  return b;
+}
+
+// maximum number of observations whose kernels are computed together (see
+// 'calc_kernel_block')
+#define KERNEL_BLOCK_SIZE 256
+
+// bits of a double, and the reverse
+inline uint64_t double_bits(const double& x) {
+  uint64_t out;
+  std::memcpy(&out, &x, sizeof(out));
+  return out;
+}
+inline double bits_double(const uint64_t& b) {
+  double out;
+  std::memcpy(&out, &b, sizeof(out));
+  return out;
+}
+
+// 'out[i] = log(x[i])' for 'i' in [0, n-1], in a loop without branches or
+// calls that the compiler can vectorise: 'x = 2^e m' with 'm' in
+// [sqrt(2)/2, sqrt(2)) (split on the bits of 'x', as comparisons of doubles
+// are not if-converted) and 'log(m) = 2 atanh((m - 1) / (m + 1))' by its
+// series (within about 2 ulp). The arguments that are not positive normal
+// numbers (0, negative, subnormal, Inf or NaN) are then passed to 'log', so
+// that 'x' and 'out' must not overlap
+inline void vec_log(const double* x, double* out, const int& n) {
+  const double ln2_hi = 6.93147180369123816490e-01;  // ln(2) split so that
+  const double ln2_lo = 1.90821492927058770002e-10;  // 'e ln2_hi' is exact
+  const double two52 = 4503599627370496.0;           // 2^52
+#pragma omp simd
+  for (int i = 0; i < n; i++) {
+    uint64_t b = double_bits(x[i]);
+    uint64_t mant = b & 0x000fffffffffffffULL;
+    uint64_t big = (mant > 0x6a09e667f3bccULL);  // mantissa above sqrt(2)
+    double e = bits_double(((b >> 52) + big) | double_bits(two52)) - two52 - 1023;
+    double m = bits_double(mant | (0x3ff0000000000000ULL - (big << 52)));
+    double f = (m - 1) / (m + 1), s = f * f;
+    double p = 1.0 / 21;
+    p = 1.0 / 19 + s * p;
+    p = 1.0 / 17 + s * p;
+    p = 1.0 / 15 + s * p;
+    p = 1.0 / 13 + s * p;
+    p = 1.0 / 11 + s * p;
+    p = 1.0 / 9 + s * p;
+    p = 1.0 / 7 + s * p;
+    p = 1.0 / 5 + s * p;
+    p = 1.0 / 3 + s * p;
+    out[i] = e * ln2_hi + (e * ln2_lo + 2 * f * (1 + s * p));
+  }
+  for (int i = 0; i < n; i++)
+    if (!(x[i] >= DBL_MIN && x[i] <= DBL_MAX)) out[i] = log(x[i]);
+}
+
+// 'out[i] = exp(x[i])' for 'i' in [0, n-1], vectorisable as 'vec_log':
+// 'x = k ln(2) + r' with 'k' the nearest integer to 'x / ln(2)', 'exp(r)' by
+// its Taylor series to degree 13 and '2^k' built from its bits (within about
+// 1 ulp). The arguments outside [-708, 708] (where '2^k' would not be
+// normal, and the bits are meaningless) are then passed to 'exp' ('x' and
+// 'out' must not overlap)
+inline void vec_exp(const double* x, double* out, const int& n) {
+  const double ln2_hi = 6.93147180369123816490e-01;
+  const double ln2_lo = 1.90821492927058770002e-10;
+  const double shift = 6755399441055744.0;  // 1.5 2^52: rounds to integers
+#pragma omp simd
+  for (int i = 0; i < n; i++) {
+    double t = x[i] * M_LOG2E + shift;
+    double k = t - shift;
+    uint64_t scale = (double_bits(t) - double_bits(shift) + 1023) << 52;
+    double r = (x[i] - k * ln2_hi) - k * ln2_lo;
+    double p = 1.0 / 6227020800;  // 1 / 13!
+    p = 1.0 / 479001600 + r * p;
+    p = 1.0 / 39916800 + r * p;
+    p = 1.0 / 3628800 + r * p;
+    p = 1.0 / 362880 + r * p;
+    p = 1.0 / 40320 + r * p;
+    p = 1.0 / 5040 + r * p;
+    p = 1.0 / 720 + r * p;
+    p = 1.0 / 120 + r * p;
+    p = 1.0 / 24 + r * p;
+    p = 1.0 / 6 + r * p;
+    p = 0.5 + r * p;
+    p = 1 + r * p;
+    out[i] = (1 + r * p) * bits_double(scale);
+  }
+  for (int i = 0; i < n; i++)
+    if (!(x[i] >= -708.0 && x[i] <= 708.0)) out[i] = exp(x[i]);
 }
 
 template <typename T>
@@ -82,6 +230,55 @@ inline int sampleState(const NumericVector& P) {
   return ct - 1;
 }
 
+// cumulative sums of the 'nrow' rows of length 'n' of the row-major 'p'
+inline void cumulate_rows(const double* p, const int& nrow, const int& n,
+                          double* cum) {
+  for (int r = 0; r < nrow; r++) {
+    double tmp = 0;
+    for (int k = 0; k < n; k++) tmp += p[r * n + k], cum[r * n + k] = tmp;
+  }
+}
+
+// samples the state given the cumulative probabilities 'cum' (of size 'n')
+// and a uniform draw 'u', as 'sampleState'
+inline int sampleCum(const double* cum, const int& n, const double& u) {
+  int s = 0;
+  while (u > cum[s] && s < n - 1) s++;
+  return s;
+}
+
+// Walker's alias table of the probabilities 'p' (of size 'n'), built with
+// Vose's method: see 'sampleAlias'
+inline void build_alias(const double* p, const int& n, double* prob,
+                        int* alias) {
+  std::vector<double> q(n);
+  std::vector<int> small, large;
+  for (int i = 0; i < n; i++) {
+    q[i] = p[i] * n;
+    if (q[i] < 1) small.push_back(i);
+    else large.push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    int s = small.back(), l = large.back();
+    small.pop_back(), large.pop_back();
+    prob[s] = q[s], alias[s] = l;
+    q[l] = (q[l] + q[s]) - 1;
+    if (q[l] < 1) small.push_back(l);
+    else large.push_back(l);
+  }
+  for (size_t i = 0; i < large.size(); i++) prob[large[i]] = 1, alias[large[i]] = large[i];
+  for (size_t i = 0; i < small.size(); i++) prob[small[i]] = 1, alias[small[i]] = small[i];
+}
+
+// samples the state in O(1) from the alias table of 'build_alias' and a
+// single uniform draw 'u'
+inline int sampleAlias(const double* prob, const int* alias, const int& n,
+                       const double& u) {
+  double x = u * n;
+  int j = std::min((int)x, n - 1);
+  return ((x - j < prob[j]) ? j : alias[j]);
+}
+
 // Rcpp implementation of v %*% M
 inline NumericVector matrixProd(const NumericVector& v,
                                 const NumericMatrix& M) {
@@ -91,4 +288,176 @@ inline NumericVector matrixProd(const NumericVector& v,
   return out;
 }
 
+// number of threads used by the parallel loops of the package (set from R
+// with 'SetThreads'); the parallel sections never call the R API
+inline int& nb_threads() {
+  static int n = 1;
+  return n;
+}
+
+// method used to draw the innovations (set from R with 'SetRndMethod'):
+// 0 for the inverse transform of uniform draws, 1 for a direct transform of
+// normal/gamma draws and 2 for a table of quantiles (see 'QuantileTable')
+inline int& rnd_method() {
+  static int method = 0;
+  return method;
+}
+
+// same, for the draws of the worker threads (see 'sim_parallel'): the exact
+// inverse transform calls the R API and falls back there to the table of
+// quantiles
+inline int rnd_method_thread() {
+  return ((rnd_method() == 0) ? 2 : rnd_method());
+}
+
+// variance reduction of the simulations ahead of the data (set from R with
+// 'SetSimMethod'): 0 for none, 1 for antithetic pairs of paths and 2 for
+// randomized quasi-Monte Carlo (see 'sim_uniforms')
+inline int& sim_method() {
+  static int method = 0;
+  return method;
+}
+
+// algorithm of the Hamilton filter of the Markov-switching models (set from
+// R with 'SetFilterMethod'): 0 for the scaled probabilities (see
+// 'HamiltonStep') and 1 for the log-space filter (see 'HamiltonStepLog')
+inline int& filter_method() {
+  static int method = 0;
+  return method;
+}
+
+// evaluation of the likelihood of the Markov-switching models (set from R with
+// 'SetFilterScan'): 0 for the sequential filter, in parallel over the vectors
+// of parameters, and 1 for the parallel scan over chunks of the data (see
+// 'HamiltonScan'), one vector of parameters at a time
+inline int& filter_scan() {
+  static int scan = 0;
+  return scan;
+}
+
+// quantile function of the standard normal distribution (Wichura's algorithm
+// AS 241, relative accuracy of about 1e-16), free of the R API so that it can
+// be called on worker threads
+inline double norm_quantile(const double& p) {
+  double q = p - 0.5, r, x;
+  if (fabs(q) <= 0.425) {
+    r = 0.180625 - q * q;
+    return q *
+           (((((((2509.0809287301226727 * r + 33430.575583588128105) * r +
+                 67265.770927008700853) * r + 45921.953931549871457) * r +
+               13731.693765509461125) * r + 1971.5909503065514427) * r +
+             133.14166789178437745) * r + 3.387132872796366608) /
+           (((((((5226.495278852545925 * r + 28729.085735721942674) * r +
+                 39307.89580009271061) * r + 21213.794301586595867) * r +
+               5394.1960214247511077) * r + 687.1870074920579083) * r +
+             42.313330701600911252) * r + 1.0);
+  }
+  r = ((q < 0) ? p : 1 - p);
+  if (r <= 0) return ((q < 0) ? R_NegInf : R_PosInf);
+  r = sqrt(-log(r));
+  if (r <= 5) {
+    r -= 1.6;
+    x = (((((((7.7454501427834140764e-4 * r + 0.0227238449892691845833) * r +
+              0.24178072517745061177) * r + 1.27045825245236838258) * r +
+            3.64784832476320460504) * r + 5.7694972214606914055) * r +
+          4.6303378461565452959) * r + 1.42343711074968357734) /
+        (((((((1.05075007164441684324e-9 * r + 5.475938084995344946e-4) * r +
+              0.0151986665636164571966) * r + 0.14810397642748007459) * r +
+            0.68976733498510000455) * r + 1.6763848301838038494) * r +
+          2.05319162663775882187) * r + 1.0);
+  } else {
+    r -= 5;
+    x = (((((((2.01033439929228813265e-7 * r + 2.71155556874348757815e-5) * r +
+              0.0012426609473880784386) * r + 0.026532189526576123093) * r +
+            0.29656057182850489123) * r + 1.7848265399172913358) * r +
+          5.4637849111641143699) * r + 6.6579046435011037772) /
+        (((((((2.04426310338993978564e-15 * r + 1.4215117583164458887e-7) * r +
+              1.8463183175100546818e-5) * r + 7.868691311456132591e-4) * r +
+            0.0148753612908506148525) * r + 0.13692988092273580531) * r +
+          0.59983220655588793769) * r + 1.0);
+  }
+  return ((q < 0) ? -x : x);
+}
+
+// quantile function of a symmetric distribution tabulated for the value
+// 'par' of its parameter: on regularly spaced probabilities 'i / QTABLE_SIZE'
+// in the body, and, in the QTABLE_TAIL_CELLS first and last cells where the
+// quantile grows fast, as its logarithm on QTABLE_TAIL probabilities
+// regularly spaced in logarithm down to exp(QTABLE_LNP_MIN) (below the
+// smallest uniform draw); both are linearly interpolated (relative error
+// below 1e-4). The table is built with 'Dist::invsample' (R API, main thread
+// only), after which 'get' can be called on worker threads
+#define QTABLE_SIZE 4096
+#define QTABLE_TAIL_CELLS 64
+#define QTABLE_TAIL 1024
+#define QTABLE_LNP_MIN -40.0
+struct QuantileTable {
+  double par;
+  std::vector<double> q;     // quantiles of 'i / QTABLE_SIZE'
+  std::vector<double> tail;  // log(-quantile) of 'exp(lnp_min + j * step)'
+
+  QuantileTable() : par(0) {}
+
+  static double tail_step() {
+    return (log((double)QTABLE_TAIL_CELLS / QTABLE_SIZE) - QTABLE_LNP_MIN) /
+           (QTABLE_TAIL - 1);
+  }
+
+  // builds the table of 'par'
+  template <typename Dist>
+  void prep(Dist& f, const double& par_) {
+    par = par_;
+    q.resize(QTABLE_SIZE + 1);
+    for (int i = QTABLE_TAIL_CELLS; i <= QTABLE_SIZE - QTABLE_TAIL_CELLS; i++)
+      q[i] = f.invsample((double)i / QTABLE_SIZE);
+    tail.resize(QTABLE_TAIL);
+    for (int j = 0; j < QTABLE_TAIL; j++)
+      tail[j] = log(-f.invsample(exp(QTABLE_LNP_MIN + j * tail_step())));
+  }
+
+  double get(const double& u) const {
+    double x = u * QTABLE_SIZE;
+    int i = (int)x;
+    if (i < QTABLE_TAIL_CELLS) return -get_tail(u);
+    if (i >= QTABLE_SIZE - QTABLE_TAIL_CELLS) return get_tail(1 - u);
+    return q[i] + (x - i) * (q[i + 1] - q[i]);
+  }
+
+  // absolute value of the quantile of 'p' in the lower tail
+  double get_tail(const double& p) const {
+    double x = (log(p) - QTABLE_LNP_MIN) / tail_step();
+    if (!(x > 0)) return exp(tail[0]);
+    int j = (int)x;
+    if (j >= QTABLE_TAIL - 1) return exp(tail[QTABLE_TAIL - 1]);
+    return exp(tail[j] + (x - j) * (tail[j + 1] - tail[j]));
+  }
+};
+
+// table of quantiles of the distribution 'Dist' for the value 'par' of its
+// parameter, shared by all the instances of the distribution so that the
+// models (and their copies, see 'Base::clone') only hold a pointer to it;
+// the QTABLE_CACHE tables built last are kept (main thread only)
+#define QTABLE_CACHE 16
+template <typename Dist>
+inline std::shared_ptr<const QuantileTable> quantile_table(Dist& f,
+                                                           const double& par) {
+  static std::vector<std::shared_ptr<const QuantileTable> > cache;
+  for (size_t i = 0; i < cache.size(); i++)
+    if (cache[i]->par == par) return cache[i];
+  std::shared_ptr<QuantileTable> out = std::make_shared<QuantileTable>();
+  out->prep(f, par);
+  if (cache.size() == QTABLE_CACHE) cache.erase(cache.begin());
+  cache.push_back(out);
+  return out;
+}
+
+// index of the calling thread in a parallel section
+inline int thread_id() {
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
 #endif  // Utils.h
@@ -78,14 +78,67 @@ class eGARCH {
     vol.h = exp(vol.lnh);
   }
 
+  // the recursion is on "lnh" and needs "h" at the next step: both are
+  // incremented together and "set_lnh_block" has nothing to do (see
+  // 'SingleRegime::calc_lnd')
+  void increment_h(volatility& vol, const double& yim1) {
+    increment_vol(vol, yim1);
+  }
+  void set_lnh_block(const double*, double*, const int&) {}
+
+  // same as "set_vol", also setting the derivatives of "h" with respect to
+  // the coefficients of the model in "dh"
+  volatility set_vol_grad(const double& y0, double* dh) {
+    volatility out = set_vol(y0);
+    double den = 1 - beta;
+    dh[0] = out.h / den, dh[1] = 0, dh[2] = 0, dh[3] = out.h * out.lnh / den;
+    return out;
+  }
+
+  // same as "increment_vol", also incrementing the derivatives in "dh"
+  // (the recursion is on "lnh"); returns the derivative of "h" with respect
+  // to its previous value
+  double increment_vol_grad(volatility& vol, double* dh, const double& yim1) {
+    double hm1 = vol.h, lnhm1 = vol.lnh;
+    double z = yim1 / sqrt(hm1);
+    double c = beta - 0.5 * z * (alpha1 * signum(z) + alpha2);  // dlnh/dlnhm1
+    increment_vol(vol, yim1);
+    dh[0] = vol.h * (1 + c * dh[0] / hm1);
+    dh[1] = vol.h * (fabs(z) - fz.Eabsz + c * dh[1] / hm1);
+    dh[2] = vol.h * (z + c * dh[2] / hm1);
+    dh[3] = vol.h * (lnhm1 + c * dh[3] / hm1);
+    return vol.h * c / hm1;
+  }
+
+  // no closed form for the expected variance (the recursion is on the
+  // log-variance, see 'f_forecast_var')
+  bool forecast_coeffs(double* c) { return false; }
+
   // some nested-call functions
   void prep_kernel() { fz.prep_kernel(); }
   NumericVector rndgen(const int& n) { return fz.rndgen(n); }
+  template <typename Gen>
+  double draw(Gen& gen, const int& method) {
+    return fz.draw(gen, method);
+  }
+  double invsample(const double& u) { return fz.calc_invsample(u); }
+  void prep_rnd() { fz.prep_rnd(); }
+  double invsample_table(const double& u) {
+    return fz.calc_invsample_table(u);
+  }
+  void prep_table() { fz.prep_table(); }
   double calc_pdf(const double& x) { return fz.calc_pdf(x); }
   double calc_cdf(const double& x) { return fz.calc_cdf(x); }
   double calc_kernel(const volatility& vol, const double& yi) {
     return fz.calc_kernel(vol, yi);
   }
+  void calc_kernel_block(const double* h, const double* lnh, const double* y,
+                         double* out, const int& n) {
+    fz.calc_kernel_block(h, lnh, y, out, n);
+  }
+  double calc_kernel_dh(const volatility& vol, const double& yi) {
+    return fz.calc_kernel_dh(vol, yi);
+  }
 };
 
 #endif  // eGARCH.h
@@ -39,6 +39,7 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_cdf", &gjrGARCH_norm::f_cdf)
       .method("f_cdf_its", &gjrGARCH_norm::f_cdf_its)
       .method("f_simAhead", &gjrGARCH_norm::f_simAhead)
+      .method("f_simAhead_filter", &gjrGARCH_norm::f_simAhead_filter)
       .method("f_get_sd", &gjrGARCH_norm::get_sd)
       .method("f_set_sd", &gjrGARCH_norm::set_sd)
       .method("f_get_mean", &gjrGARCH_norm::get_mean)
@@ -46,6 +47,17 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_rnd", &gjrGARCH_norm::f_rnd)
       .method("calc_ht", &gjrGARCH_norm::calc_ht)
       .method("eval_model", &gjrGARCH_norm::eval_model)
+      .method("eval_model_grad", &gjrGARCH_norm::eval_model_grad)
+      .method("eval_model_score", &gjrGARCH_norm::eval_model_score)
+      .method("f_mcmc", &gjrGARCH_norm::f_mcmc)
+      .method("f_mcmc_chains", &gjrGARCH_norm::f_mcmc_chains)
+      .method("f_filter_init", &gjrGARCH_norm::f_filter_init)
+      .method("f_filter_update", &gjrGARCH_norm::f_filter_update)
+      .method("f_forecast_var", &gjrGARCH_norm::f_forecast_var)
+      .method("f_forecast_var_filter", &gjrGARCH_norm::f_forecast_var_filter)
+      .method("f_pred_filter", &gjrGARCH_norm::f_pred_filter)
+      .method("f_risk", &gjrGARCH_norm::f_risk)
+      .method("f_risk_filter", &gjrGARCH_norm::f_risk_filter)
       .method("ineq_func", &gjrGARCH_norm::ineq_func)
       .method("f_unc_vol", &gjrGARCH_norm::f_unc_vol);
   // gjrGARCH-std-symmetric
@@ -67,6 +79,7 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_cdf", &gjrGARCH_std::f_cdf)
       .method("f_cdf_its", &gjrGARCH_std::f_cdf_its)
       .method("f_simAhead", &gjrGARCH_std::f_simAhead)
+      .method("f_simAhead_filter", &gjrGARCH_std::f_simAhead_filter)
       .method("f_get_sd", &gjrGARCH_std::get_sd)
       .method("f_set_sd", &gjrGARCH_std::set_sd)
       .method("f_get_mean", &gjrGARCH_std::get_mean)
@@ -74,6 +87,17 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_rnd", &gjrGARCH_std::f_rnd)
       .method("calc_ht", &gjrGARCH_std::calc_ht)
       .method("eval_model", &gjrGARCH_std::eval_model)
+      .method("eval_model_grad", &gjrGARCH_std::eval_model_grad)
+      .method("eval_model_score", &gjrGARCH_std::eval_model_score)
+      .method("f_mcmc", &gjrGARCH_std::f_mcmc)
+      .method("f_mcmc_chains", &gjrGARCH_std::f_mcmc_chains)
+      .method("f_filter_init", &gjrGARCH_std::f_filter_init)
+      .method("f_filter_update", &gjrGARCH_std::f_filter_update)
+      .method("f_forecast_var", &gjrGARCH_std::f_forecast_var)
+      .method("f_forecast_var_filter", &gjrGARCH_std::f_forecast_var_filter)
+      .method("f_pred_filter", &gjrGARCH_std::f_pred_filter)
+      .method("f_risk", &gjrGARCH_std::f_risk)
+      .method("f_risk_filter", &gjrGARCH_std::f_risk_filter)
       .method("ineq_func", &gjrGARCH_std::ineq_func)
       .method("f_unc_vol", &gjrGARCH_std::f_unc_vol);
   // gjrGARCH-ged-symmetric
@@ -95,6 +119,7 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_cdf", &gjrGARCH_ged::f_cdf)
       .method("f_cdf_its", &gjrGARCH_ged::f_cdf_its)
       .method("f_simAhead", &gjrGARCH_ged::f_simAhead)
+      .method("f_simAhead_filter", &gjrGARCH_ged::f_simAhead_filter)
       .method("f_get_sd", &gjrGARCH_ged::get_sd)
       .method("f_set_sd", &gjrGARCH_ged::set_sd)
       .method("f_get_mean", &gjrGARCH_ged::get_mean)
@@ -102,6 +127,17 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_rnd", &gjrGARCH_ged::f_rnd)
       .method("calc_ht", &gjrGARCH_ged::calc_ht)
       .method("eval_model", &gjrGARCH_ged::eval_model)
+      .method("eval_model_grad", &gjrGARCH_ged::eval_model_grad)
+      .method("eval_model_score", &gjrGARCH_ged::eval_model_score)
+      .method("f_mcmc", &gjrGARCH_ged::f_mcmc)
+      .method("f_mcmc_chains", &gjrGARCH_ged::f_mcmc_chains)
+      .method("f_filter_init", &gjrGARCH_ged::f_filter_init)
+      .method("f_filter_update", &gjrGARCH_ged::f_filter_update)
+      .method("f_forecast_var", &gjrGARCH_ged::f_forecast_var)
+      .method("f_forecast_var_filter", &gjrGARCH_ged::f_forecast_var_filter)
+      .method("f_pred_filter", &gjrGARCH_ged::f_pred_filter)
+      .method("f_risk", &gjrGARCH_ged::f_risk)
+      .method("f_risk_filter", &gjrGARCH_ged::f_risk_filter)
       .method("ineq_func", &gjrGARCH_ged::ineq_func)
       .method("f_unc_vol", &gjrGARCH_ged::f_unc_vol);
 
@@ -124,6 +160,7 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_cdf", &gjrGARCH_snorm::f_cdf)
       .method("f_cdf_its", &gjrGARCH_snorm::f_cdf_its)
       .method("f_simAhead", &gjrGARCH_snorm::f_simAhead)
+      .method("f_simAhead_filter", &gjrGARCH_snorm::f_simAhead_filter)
       .method("f_get_sd", &gjrGARCH_snorm::get_sd)
       .method("f_set_sd", &gjrGARCH_snorm::set_sd)
       .method("f_get_mean", &gjrGARCH_snorm::get_mean)
@@ -131,6 +168,17 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_rnd", &gjrGARCH_snorm::f_rnd)
       .method("calc_ht", &gjrGARCH_snorm::calc_ht)
       .method("eval_model", &gjrGARCH_snorm::eval_model)
+      .method("eval_model_grad", &gjrGARCH_snorm::eval_model_grad)
+      .method("eval_model_score", &gjrGARCH_snorm::eval_model_score)
+      .method("f_mcmc", &gjrGARCH_snorm::f_mcmc)
+      .method("f_mcmc_chains", &gjrGARCH_snorm::f_mcmc_chains)
+      .method("f_filter_init", &gjrGARCH_snorm::f_filter_init)
+      .method("f_filter_update", &gjrGARCH_snorm::f_filter_update)
+      .method("f_forecast_var", &gjrGARCH_snorm::f_forecast_var)
+      .method("f_forecast_var_filter", &gjrGARCH_snorm::f_forecast_var_filter)
+      .method("f_pred_filter", &gjrGARCH_snorm::f_pred_filter)
+      .method("f_risk", &gjrGARCH_snorm::f_risk)
+      .method("f_risk_filter", &gjrGARCH_snorm::f_risk_filter)
       .method("ineq_func", &gjrGARCH_snorm::ineq_func)
       .method("f_unc_vol", &gjrGARCH_snorm::f_unc_vol);
   // gjrGARCH-std-skew
@@ -152,6 +200,7 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_cdf", &gjrGARCH_sstd::f_cdf)
       .method("f_cdf_its", &gjrGARCH_sstd::f_cdf_its)
       .method("f_simAhead", &gjrGARCH_sstd::f_simAhead)
+      .method("f_simAhead_filter", &gjrGARCH_sstd::f_simAhead_filter)
       .method("f_get_sd", &gjrGARCH_sstd::get_sd)
       .method("f_set_sd", &gjrGARCH_sstd::set_sd)
       .method("f_get_mean", &gjrGARCH_sstd::get_mean)
@@ -159,6 +208,17 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_rnd", &gjrGARCH_sstd::f_rnd)
       .method("calc_ht", &gjrGARCH_sstd::calc_ht)
       .method("eval_model", &gjrGARCH_sstd::eval_model)
+      .method("eval_model_grad", &gjrGARCH_sstd::eval_model_grad)
+      .method("eval_model_score", &gjrGARCH_sstd::eval_model_score)
+      .method("f_mcmc", &gjrGARCH_sstd::f_mcmc)
+      .method("f_mcmc_chains", &gjrGARCH_sstd::f_mcmc_chains)
+      .method("f_filter_init", &gjrGARCH_sstd::f_filter_init)
+      .method("f_filter_update", &gjrGARCH_sstd::f_filter_update)
+      .method("f_forecast_var", &gjrGARCH_sstd::f_forecast_var)
+      .method("f_forecast_var_filter", &gjrGARCH_sstd::f_forecast_var_filter)
+      .method("f_pred_filter", &gjrGARCH_sstd::f_pred_filter)
+      .method("f_risk", &gjrGARCH_sstd::f_risk)
+      .method("f_risk_filter", &gjrGARCH_sstd::f_risk_filter)
       .method("ineq_func", &gjrGARCH_sstd::ineq_func)
       .method("f_unc_vol", &gjrGARCH_sstd::f_unc_vol);
   // gjrGARCH-ged-skew
@@ -180,6 +240,7 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_cdf", &gjrGARCH_sged::f_cdf)
       .method("f_cdf_its", &gjrGARCH_sged::f_cdf_its)
       .method("f_simAhead", &gjrGARCH_sged::f_simAhead)
+      .method("f_simAhead_filter", &gjrGARCH_sged::f_simAhead_filter)
       .method("f_get_sd", &gjrGARCH_sged::get_sd)
       .method("f_set_sd", &gjrGARCH_sged::set_sd)
       .method("f_get_mean", &gjrGARCH_sged::get_mean)
@@ -187,6 +248,17 @@ RCPP_MODULE(gjrGARCH) {
       .method("f_rnd", &gjrGARCH_sged::f_rnd)
       .method("calc_ht", &gjrGARCH_sged::calc_ht)
       .method("eval_model", &gjrGARCH_sged::eval_model)
+      .method("eval_model_grad", &gjrGARCH_sged::eval_model_grad)
+      .method("eval_model_score", &gjrGARCH_sged::eval_model_score)
+      .method("f_mcmc", &gjrGARCH_sged::f_mcmc)
+      .method("f_mcmc_chains", &gjrGARCH_sged::f_mcmc_chains)
+      .method("f_filter_init", &gjrGARCH_sged::f_filter_init)
+      .method("f_filter_update", &gjrGARCH_sged::f_filter_update)
+      .method("f_forecast_var", &gjrGARCH_sged::f_forecast_var)
+      .method("f_forecast_var_filter", &gjrGARCH_sged::f_forecast_var_filter)
+      .method("f_pred_filter", &gjrGARCH_sged::f_pred_filter)
+      .method("f_risk", &gjrGARCH_sged::f_risk)
+      .method("f_risk_filter", &gjrGARCH_sged::f_risk_filter)
       .method("ineq_func", &gjrGARCH_sged::ineq_func)
       .method("f_unc_vol", &gjrGARCH_sged::f_unc_vol);
 }
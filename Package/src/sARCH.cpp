@@ -38,6 +38,7 @@ RCPP_MODULE(sARCH) {
       .method("f_cdf", &sARCH_norm::f_cdf)
       .method("f_cdf_its", &sARCH_norm::f_cdf_its)
       .method("f_simAhead", &sARCH_norm::f_simAhead)
+      .method("f_simAhead_filter", &sARCH_norm::f_simAhead_filter)
       .method("f_get_sd", &sARCH_norm::get_sd)
       .method("f_set_sd", &sARCH_norm::set_sd)
       .method("f_get_mean", &sARCH_norm::get_mean)
@@ -45,6 +46,17 @@ RCPP_MODULE(sARCH) {
       .method("f_rnd", &sARCH_norm::f_rnd)
       .method("calc_ht", &sARCH_norm::calc_ht)
       .method("eval_model", &sARCH_norm::eval_model)
+      .method("eval_model_grad", &sARCH_norm::eval_model_grad)
+      .method("eval_model_score", &sARCH_norm::eval_model_score)
+      .method("f_mcmc", &sARCH_norm::f_mcmc)
+      .method("f_mcmc_chains", &sARCH_norm::f_mcmc_chains)
+      .method("f_filter_init", &sARCH_norm::f_filter_init)
+      .method("f_filter_update", &sARCH_norm::f_filter_update)
+      .method("f_forecast_var", &sARCH_norm::f_forecast_var)
+      .method("f_forecast_var_filter", &sARCH_norm::f_forecast_var_filter)
+      .method("f_pred_filter", &sARCH_norm::f_pred_filter)
+      .method("f_risk", &sARCH_norm::f_risk)
+      .method("f_risk_filter", &sARCH_norm::f_risk_filter)
       .method("ineq_func", &sARCH_norm::ineq_func)
       .method("f_unc_vol", &sARCH_norm::f_unc_vol);
   // sARCH-std-symmetric
@@ -66,6 +78,7 @@ RCPP_MODULE(sARCH) {
       .method("f_cdf", &sARCH_std::f_cdf)
       .method("f_cdf_its", &sARCH_std::f_cdf_its)
       .method("f_simAhead", &sARCH_std::f_simAhead)
+      .method("f_simAhead_filter", &sARCH_std::f_simAhead_filter)
       .method("f_get_sd", &sARCH_std::get_sd)
       .method("f_set_sd", &sARCH_std::set_sd)
       .method("f_get_mean", &sARCH_std::get_mean)
@@ -73,6 +86,17 @@ RCPP_MODULE(sARCH) {
       .method("f_rnd", &sARCH_std::f_rnd)
       .method("calc_ht", &sARCH_std::calc_ht)
       .method("eval_model", &sARCH_std::eval_model)
+      .method("eval_model_grad", &sARCH_std::eval_model_grad)
+      .method("eval_model_score", &sARCH_std::eval_model_score)
+      .method("f_mcmc", &sARCH_std::f_mcmc)
+      .method("f_mcmc_chains", &sARCH_std::f_mcmc_chains)
+      .method("f_filter_init", &sARCH_std::f_filter_init)
+      .method("f_filter_update", &sARCH_std::f_filter_update)
+      .method("f_forecast_var", &sARCH_std::f_forecast_var)
+      .method("f_forecast_var_filter", &sARCH_std::f_forecast_var_filter)
+      .method("f_pred_filter", &sARCH_std::f_pred_filter)
+      .method("f_risk", &sARCH_std::f_risk)
+      .method("f_risk_filter", &sARCH_std::f_risk_filter)
       .method("ineq_func", &sARCH_std::ineq_func)
       .method("f_unc_vol", &sARCH_std::f_unc_vol);
   // sARCH-ged-symmetric
@@ -94,6 +118,7 @@ RCPP_MODULE(sARCH) {
       .method("f_cdf", &sARCH_ged::f_cdf)
       .method("f_cdf_its", &sARCH_ged::f_cdf_its)
       .method("f_simAhead", &sARCH_ged::f_simAhead)
+      .method("f_simAhead_filter", &sARCH_ged::f_simAhead_filter)
       .method("f_get_sd", &sARCH_ged::get_sd)
       .method("f_set_sd", &sARCH_ged::set_sd)
       .method("f_get_mean", &sARCH_ged::get_mean)
@@ -101,6 +126,17 @@ RCPP_MODULE(sARCH) {
       .method("f_rnd", &sARCH_ged::f_rnd)
       .method("calc_ht", &sARCH_ged::calc_ht)
       .method("eval_model", &sARCH_ged::eval_model)
+      .method("eval_model_grad", &sARCH_ged::eval_model_grad)
+      .method("eval_model_score", &sARCH_ged::eval_model_score)
+      .method("f_mcmc", &sARCH_ged::f_mcmc)
+      .method("f_mcmc_chains", &sARCH_ged::f_mcmc_chains)
+      .method("f_filter_init", &sARCH_ged::f_filter_init)
+      .method("f_filter_update", &sARCH_ged::f_filter_update)
+      .method("f_forecast_var", &sARCH_ged::f_forecast_var)
+      .method("f_forecast_var_filter", &sARCH_ged::f_forecast_var_filter)
+      .method("f_pred_filter", &sARCH_ged::f_pred_filter)
+      .method("f_risk", &sARCH_ged::f_risk)
+      .method("f_risk_filter", &sARCH_ged::f_risk_filter)
       .method("ineq_func", &sARCH_ged::ineq_func)
       .method("f_unc_vol", &sARCH_ged::f_unc_vol);
 
@@ -123,6 +159,7 @@ RCPP_MODULE(sARCH) {
       .method("f_cdf", &sARCH_snorm::f_cdf)
       .method("f_cdf_its", &sARCH_snorm::f_cdf_its)
       .method("f_simAhead", &sARCH_snorm::f_simAhead)
+      .method("f_simAhead_filter", &sARCH_snorm::f_simAhead_filter)
       .method("f_get_sd", &sARCH_snorm::get_sd)
       .method("f_set_sd", &sARCH_snorm::set_sd)
       .method("f_get_mean", &sARCH_snorm::get_mean)
@@ -130,6 +167,17 @@ RCPP_MODULE(sARCH) {
       .method("f_rnd", &sARCH_snorm::f_rnd)
       .method("calc_ht", &sARCH_snorm::calc_ht)
       .method("eval_model", &sARCH_snorm::eval_model)
+      .method("eval_model_grad", &sARCH_snorm::eval_model_grad)
+      .method("eval_model_score", &sARCH_snorm::eval_model_score)
+      .method("f_mcmc", &sARCH_snorm::f_mcmc)
+      .method("f_mcmc_chains", &sARCH_snorm::f_mcmc_chains)
+      .method("f_filter_init", &sARCH_snorm::f_filter_init)
+      .method("f_filter_update", &sARCH_snorm::f_filter_update)
+      .method("f_forecast_var", &sARCH_snorm::f_forecast_var)
+      .method("f_forecast_var_filter", &sARCH_snorm::f_forecast_var_filter)
+      .method("f_pred_filter", &sARCH_snorm::f_pred_filter)
+      .method("f_risk", &sARCH_snorm::f_risk)
+      .method("f_risk_filter", &sARCH_snorm::f_risk_filter)
       .method("ineq_func", &sARCH_snorm::ineq_func)
       .method("f_unc_vol", &sARCH_snorm::f_unc_vol);
   // sARCH-std-skew
@@ -151,6 +199,7 @@ RCPP_MODULE(sARCH) {
       .method("f_cdf", &sARCH_sstd::f_cdf)
       .method("f_cdf_its", &sARCH_sstd::f_cdf_its)
       .method("f_simAhead", &sARCH_sstd::f_simAhead)
+      .method("f_simAhead_filter", &sARCH_sstd::f_simAhead_filter)
       .method("f_get_sd", &sARCH_sstd::get_sd)
       .method("f_set_sd", &sARCH_sstd::set_sd)
       .method("f_get_mean", &sARCH_sstd::get_mean)
@@ -158,6 +207,17 @@ RCPP_MODULE(sARCH) {
       .method("f_rnd", &sARCH_sstd::f_rnd)
       .method("calc_ht", &sARCH_sstd::calc_ht)
       .method("eval_model", &sARCH_sstd::eval_model)
+      .method("eval_model_grad", &sARCH_sstd::eval_model_grad)
+      .method("eval_model_score", &sARCH_sstd::eval_model_score)
+      .method("f_mcmc", &sARCH_sstd::f_mcmc)
+      .method("f_mcmc_chains", &sARCH_sstd::f_mcmc_chains)
+      .method("f_filter_init", &sARCH_sstd::f_filter_init)
+      .method("f_filter_update", &sARCH_sstd::f_filter_update)
+      .method("f_forecast_var", &sARCH_sstd::f_forecast_var)
+      .method("f_forecast_var_filter", &sARCH_sstd::f_forecast_var_filter)
+      .method("f_pred_filter", &sARCH_sstd::f_pred_filter)
+      .method("f_risk", &sARCH_sstd::f_risk)
+      .method("f_risk_filter", &sARCH_sstd::f_risk_filter)
       .method("ineq_func", &sARCH_sstd::ineq_func)
       .method("f_unc_vol", &sARCH_sstd::f_unc_vol);
   // sARCH-ged-skew
@@ -179,6 +239,7 @@ RCPP_MODULE(sARCH) {
       .method("f_cdf", &sARCH_sged::f_cdf)
       .method("f_cdf_its", &sARCH_sged::f_cdf_its)
       .method("f_simAhead", &sARCH_sged::f_simAhead)
+      .method("f_simAhead_filter", &sARCH_sged::f_simAhead_filter)
       .method("f_get_sd", &sARCH_sged::get_sd)
       .method("f_set_sd", &sARCH_sged::set_sd)
       .method("f_get_mean", &sARCH_sged::get_mean)
@@ -186,6 +247,17 @@ RCPP_MODULE(sARCH) {
       .method("f_rnd", &sARCH_sged::f_rnd)
       .method("calc_ht", &sARCH_sged::calc_ht)
       .method("eval_model", &sARCH_sged::eval_model)
+      .method("eval_model_grad", &sARCH_sged::eval_model_grad)
+      .method("eval_model_score", &sARCH_sged::eval_model_score)
+      .method("f_mcmc", &sARCH_sged::f_mcmc)
+      .method("f_mcmc_chains", &sARCH_sged::f_mcmc_chains)
+      .method("f_filter_init", &sARCH_sged::f_filter_init)
+      .method("f_filter_update", &sARCH_sged::f_filter_update)
+      .method("f_forecast_var", &sARCH_sged::f_forecast_var)
+      .method("f_forecast_var_filter", &sARCH_sged::f_forecast_var_filter)
+      .method("f_pred_filter", &sARCH_sged::f_pred_filter)
+      .method("f_risk", &sARCH_sged::f_risk)
+      .method("f_risk_filter", &sARCH_sged::f_risk_filter)
       .method("ineq_func", &sARCH_sged::ineq_func)
       .method("f_unc_vol", &sARCH_sged::f_unc_vol);
 }
@@ -71,18 +71,72 @@ class sARCH {
 
   // increment volatility
   void increment_vol(volatility& vol, const double& yim1) {
-    vol.h = alpha0 + alpha1 * pow(yim1, 2);
+    increment_h(vol, yim1);
     vol.lnh = log(vol.h);
   }
 
+  // same as "increment_vol" without "lnh", which "set_lnh_block" then
+  // computes for a block of variances (see 'SingleRegime::calc_lnd')
+  void increment_h(volatility& vol, const double& yim1) {
+    vol.h = alpha0 + alpha1 * pow(yim1, 2);
+  }
+  void set_lnh_block(const double* h, double* lnh, const int& n) {
+    vec_log(h, lnh, n);
+  }
+
+  // same as "set_vol", also setting the derivatives of "h" with respect to
+  // the coefficients of the model in "dh"
+  volatility set_vol_grad(const double& y0, double* dh) {
+    volatility out = set_vol(y0);
+    double den = 1 - alpha1;
+    dh[0] = 1 / den, dh[1] = out.h / den;
+    return out;
+  }
+
+  // same as "increment_vol", also incrementing the derivatives in "dh";
+  // returns the derivative of "h" with respect to its previous value
+  double increment_vol_grad(volatility& vol, double* dh, const double& yim1) {
+    increment_vol(vol, yim1);
+    dh[0] = 1;
+    dh[1] = pow(yim1, 2);
+    return 0;
+  }
+
+  // coefficients of the expected variance one step ahead (see
+  // 'f_forecast_var'): 'c[0] + c[1] y^2 + c[2] y^2 I(y < 0) + c[3] h', and
+  // 'c[4] := E[z^2 * I(z<0)]' of the innovations; returns false when the
+  // expected variance has no closed form
+  bool forecast_coeffs(double* c) {
+    fz.set_Ez2Ineg();
+    c[0] = alpha0, c[1] = alpha1, c[2] = 0, c[3] = 0, c[4] = fz.Ez2Ineg;
+    return true;
+  }
+
   // some nested-call functions
   void prep_kernel() { fz.prep_kernel(); }
   NumericVector rndgen(const int& n) { return fz.rndgen(n); }
+  template <typename Gen>
+  double draw(Gen& gen, const int& method) {
+    return fz.draw(gen, method);
+  }
+  double invsample(const double& u) { return fz.calc_invsample(u); }
+  void prep_rnd() { fz.prep_rnd(); }
+  double invsample_table(const double& u) {
+    return fz.calc_invsample_table(u);
+  }
+  void prep_table() { fz.prep_table(); }
   double calc_pdf(const double& x) { return fz.calc_pdf(x); }
   double calc_cdf(const double& x) { return fz.calc_cdf(x); }
   double calc_kernel(const volatility& vol, const double& yi) {
     return fz.calc_kernel(vol, yi);
   }
+  void calc_kernel_block(const double* h, const double* lnh, const double* y,
+                         double* out, const int& n) {
+    fz.calc_kernel_block(h, lnh, y, out, n);
+  }
+  double calc_kernel_dh(const volatility& vol, const double& yi) {
+    return fz.calc_kernel_dh(vol, yi);
+  }
 };
 
 #endif  // sARCH.h
@@ -38,6 +38,7 @@ RCPP_MODULE(sGARCH) {
       .method("f_cdf", &sGARCH_norm::f_cdf)
       .method("f_cdf_its", &sGARCH_norm::f_cdf_its)
       .method("f_simAhead", &sGARCH_norm::f_simAhead)
+      .method("f_simAhead_filter", &sGARCH_norm::f_simAhead_filter)
       .method("f_get_sd", &sGARCH_norm::get_sd)
       .method("f_set_sd", &sGARCH_norm::set_sd)
       .method("f_get_mean", &sGARCH_norm::get_mean)
@@ -45,6 +46,17 @@ RCPP_MODULE(sGARCH) {
       .method("f_rnd", &sGARCH_norm::f_rnd)
       .method("calc_ht", &sGARCH_norm::calc_ht)
       .method("eval_model", &sGARCH_norm::eval_model)
+      .method("eval_model_grad", &sGARCH_norm::eval_model_grad)
+      .method("eval_model_score", &sGARCH_norm::eval_model_score)
+      .method("f_mcmc", &sGARCH_norm::f_mcmc)
+      .method("f_mcmc_chains", &sGARCH_norm::f_mcmc_chains)
+      .method("f_filter_init", &sGARCH_norm::f_filter_init)
+      .method("f_filter_update", &sGARCH_norm::f_filter_update)
+      .method("f_forecast_var", &sGARCH_norm::f_forecast_var)
+      .method("f_forecast_var_filter", &sGARCH_norm::f_forecast_var_filter)
+      .method("f_pred_filter", &sGARCH_norm::f_pred_filter)
+      .method("f_risk", &sGARCH_norm::f_risk)
+      .method("f_risk_filter", &sGARCH_norm::f_risk_filter)
       .method("ineq_func", &sGARCH_norm::ineq_func)
       .method("f_unc_vol", &sGARCH_norm::f_unc_vol);
   // sGARCH-std-symmetric
@@ -66,6 +78,7 @@ RCPP_MODULE(sGARCH) {
       .method("f_cdf", &sGARCH_std::f_cdf)
       .method("f_cdf_its", &sGARCH_std::f_cdf_its)
       .method("f_simAhead", &sGARCH_std::f_simAhead)
+      .method("f_simAhead_filter", &sGARCH_std::f_simAhead_filter)
       .method("f_get_sd", &sGARCH_std::get_sd)
       .method("f_set_sd", &sGARCH_std::set_sd)
       .method("f_get_mean", &sGARCH_std::get_mean)
@@ -73,6 +86,17 @@ RCPP_MODULE(sGARCH) {
       .method("f_rnd", &sGARCH_std::f_rnd)
       .method("calc_ht", &sGARCH_std::calc_ht)
       .method("eval_model", &sGARCH_std::eval_model)
+      .method("eval_model_grad", &sGARCH_std::eval_model_grad)
+      .method("eval_model_score", &sGARCH_std::eval_model_score)
+      .method("f_mcmc", &sGARCH_std::f_mcmc)
+      .method("f_mcmc_chains", &sGARCH_std::f_mcmc_chains)
+      .method("f_filter_init", &sGARCH_std::f_filter_init)
+      .method("f_filter_update", &sGARCH_std::f_filter_update)
+      .method("f_forecast_var", &sGARCH_std::f_forecast_var)
+      .method("f_forecast_var_filter", &sGARCH_std::f_forecast_var_filter)
+      .method("f_pred_filter", &sGARCH_std::f_pred_filter)
+      .method("f_risk", &sGARCH_std::f_risk)
+      .method("f_risk_filter", &sGARCH_std::f_risk_filter)
       .method("ineq_func", &sGARCH_std::ineq_func)
       .method("f_unc_vol", &sGARCH_std::f_unc_vol);
   // sGARCH-ged-symmetric
@@ -94,6 +118,7 @@ RCPP_MODULE(sGARCH) {
       .method("f_cdf", &sGARCH_ged::f_cdf)
       .method("f_cdf_its", &sGARCH_ged::f_cdf_its)
       .method("f_simAhead", &sGARCH_ged::f_simAhead)
+      .method("f_simAhead_filter", &sGARCH_ged::f_simAhead_filter)
       .method("f_get_sd", &sGARCH_ged::get_sd)
       .method("f_set_sd", &sGARCH_ged::set_sd)
       .method("f_get_mean", &sGARCH_ged::get_mean)
@@ -101,6 +126,17 @@ RCPP_MODULE(sGARCH) {
       .method("f_rnd", &sGARCH_ged::f_rnd)
       .method("calc_ht", &sGARCH_ged::calc_ht)
       .method("eval_model", &sGARCH_ged::eval_model)
+      .method("eval_model_grad", &sGARCH_ged::eval_model_grad)
+      .method("eval_model_score", &sGARCH_ged::eval_model_score)
+      .method("f_mcmc", &sGARCH_ged::f_mcmc)
+      .method("f_mcmc_chains", &sGARCH_ged::f_mcmc_chains)
+      .method("f_filter_init", &sGARCH_ged::f_filter_init)
+      .method("f_filter_update", &sGARCH_ged::f_filter_update)
+      .method("f_forecast_var", &sGARCH_ged::f_forecast_var)
+      .method("f_forecast_var_filter", &sGARCH_ged::f_forecast_var_filter)
+      .method("f_pred_filter", &sGARCH_ged::f_pred_filter)
+      .method("f_risk", &sGARCH_ged::f_risk)
+      .method("f_risk_filter", &sGARCH_ged::f_risk_filter)
       .method("ineq_func", &sGARCH_ged::ineq_func)
       .method("f_unc_vol", &sGARCH_ged::f_unc_vol);
 
@@ -123,6 +159,7 @@ RCPP_MODULE(sGARCH) {
       .method("f_cdf", &sGARCH_snorm::f_cdf)
       .method("f_cdf_its", &sGARCH_snorm::f_cdf_its)
       .method("f_simAhead", &sGARCH_snorm::f_simAhead)
+      .method("f_simAhead_filter", &sGARCH_snorm::f_simAhead_filter)
       .method("f_get_sd", &sGARCH_snorm::get_sd)
       .method("f_set_sd", &sGARCH_snorm::set_sd)
       .method("f_get_mean", &sGARCH_snorm::get_mean)
@@ -130,6 +167,17 @@ RCPP_MODULE(sGARCH) {
       .method("f_rnd", &sGARCH_snorm::f_rnd)
       .method("calc_ht", &sGARCH_snorm::calc_ht)
       .method("eval_model", &sGARCH_snorm::eval_model)
+      .method("eval_model_grad", &sGARCH_snorm::eval_model_grad)
+      .method("eval_model_score", &sGARCH_snorm::eval_model_score)
+      .method("f_mcmc", &sGARCH_snorm::f_mcmc)
+      .method("f_mcmc_chains", &sGARCH_snorm::f_mcmc_chains)
+      .method("f_filter_init", &sGARCH_snorm::f_filter_init)
+      .method("f_filter_update", &sGARCH_snorm::f_filter_update)
+      .method("f_forecast_var", &sGARCH_snorm::f_forecast_var)
+      .method("f_forecast_var_filter", &sGARCH_snorm::f_forecast_var_filter)
+      .method("f_pred_filter", &sGARCH_snorm::f_pred_filter)
+      .method("f_risk", &sGARCH_snorm::f_risk)
+      .method("f_risk_filter", &sGARCH_snorm::f_risk_filter)
       .method("ineq_func", &sGARCH_snorm::ineq_func)
       .method("f_unc_vol", &sGARCH_snorm::f_unc_vol);
   // sGARCH-std-skew
@@ -151,6 +199,7 @@ RCPP_MODULE(sGARCH) {
       .method("f_cdf", &sGARCH_sstd::f_cdf)
       .method("f_cdf_its", &sGARCH_sstd::f_cdf_its)
       .method("f_simAhead", &sGARCH_sstd::f_simAhead)
+      .method("f_simAhead_filter", &sGARCH_sstd::f_simAhead_filter)
       .method("f_get_sd", &sGARCH_sstd::get_sd)
       .method("f_set_sd", &sGARCH_sstd::set_sd)
       .method("f_get_mean", &sGARCH_sstd::get_mean)
@@ -158,6 +207,17 @@ RCPP_MODULE(sGARCH) {
       .method("f_rnd", &sGARCH_sstd::f_rnd)
       .method("calc_ht", &sGARCH_sstd::calc_ht)
       .method("eval_model", &sGARCH_sstd::eval_model)
+      .method("eval_model_grad", &sGARCH_sstd::eval_model_grad)
+      .method("eval_model_score", &sGARCH_sstd::eval_model_score)
+      .method("f_mcmc", &sGARCH_sstd::f_mcmc)
+      .method("f_mcmc_chains", &sGARCH_sstd::f_mcmc_chains)
+      .method("f_filter_init", &sGARCH_sstd::f_filter_init)
+      .method("f_filter_update", &sGARCH_sstd::f_filter_update)
+      .method("f_forecast_var", &sGARCH_sstd::f_forecast_var)
+      .method("f_forecast_var_filter", &sGARCH_sstd::f_forecast_var_filter)
+      .method("f_pred_filter", &sGARCH_sstd::f_pred_filter)
+      .method("f_risk", &sGARCH_sstd::f_risk)
+      .method("f_risk_filter", &sGARCH_sstd::f_risk_filter)
       .method("ineq_func", &sGARCH_sstd::ineq_func)
       .method("f_unc_vol", &sGARCH_sstd::f_unc_vol);
   // sGARCH-ged-skew
@@ -179,6 +239,7 @@ RCPP_MODULE(sGARCH) {
       .method("f_cdf", &sGARCH_sged::f_cdf)
       .method("f_cdf_its", &sGARCH_sged::f_cdf_its)
       .method("f_simAhead", &sGARCH_sged::f_simAhead)
+      .method("f_simAhead_filter", &sGARCH_sged::f_simAhead_filter)
       .method("f_get_sd", &sGARCH_sged::get_sd)
       .method("f_set_sd", &sGARCH_sged::set_sd)
       .method("f_get_mean", &sGARCH_sged::get_mean)
@@ -186,6 +247,17 @@ RCPP_MODULE(sGARCH) {
       .method("f_rnd", &sGARCH_sged::f_rnd)
       .method("calc_ht", &sGARCH_sged::calc_ht)
       .method("eval_model", &sGARCH_sged::eval_model)
+      .method("eval_model_grad", &sGARCH_sged::eval_model_grad)
+      .method("eval_model_score", &sGARCH_sged::eval_model_score)
+      .method("f_mcmc", &sGARCH_sged::f_mcmc)
+      .method("f_mcmc_chains", &sGARCH_sged::f_mcmc_chains)
+      .method("f_filter_init", &sGARCH_sged::f_filter_init)
+      .method("f_filter_update", &sGARCH_sged::f_filter_update)
+      .method("f_forecast_var", &sGARCH_sged::f_forecast_var)
+      .method("f_forecast_var_filter", &sGARCH_sged::f_forecast_var_filter)
+      .method("f_pred_filter", &sGARCH_sged::f_pred_filter)
+      .method("f_risk", &sGARCH_sged::f_risk)
+      .method("f_risk_filter", &sGARCH_sged::f_risk_filter)
       .method("ineq_func", &sGARCH_sged::ineq_func)
       .method("f_unc_vol", &sGARCH_sged::f_unc_vol);
 }
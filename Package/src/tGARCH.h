@@ -77,19 +77,74 @@ class tGARCH {
 
   // increment volatility
   void increment_vol(volatility& vol, const double& yim1) {
+    increment_h(vol, yim1);
+    vol.lnh = log(vol.h);
+  }
+
+  // same as "increment_vol" without "lnh", which "set_lnh_block" then
+  // computes for a block of variances (see 'SingleRegime::calc_lnd')
+  void increment_h(volatility& vol, const double& yim1) {
     vol.fh = alpha0 + beta * vol.fh + ((yim1 >= 0) ? alpha1 : -alpha2) * yim1;
     vol.h = pow(vol.fh, 2);
-    vol.lnh = log(vol.h);
+  }
+  void set_lnh_block(const double* h, double* lnh, const int& n) {
+    vec_log(h, lnh, n);
+  }
+
+  // same as "set_vol", also setting the derivatives of "h" with respect to
+  // the coefficients of the model in "dh"
+  volatility set_vol_grad(const double& y0, double* dh) {
+    volatility out = set_vol(y0);
+    double den = 1 + (alpha1 + alpha2) * fz.EzIneg - beta;
+    double dfh = 2 * out.fh / den;  // dh / d(fh) divided by "den"
+    dh[0] = dfh, dh[1] = -dfh * out.fh * fz.EzIneg,
+    dh[2] = -dfh * out.fh * fz.EzIneg, dh[3] = dfh * out.fh;
+    return out;
   }
 
+  // same as "increment_vol", also incrementing the derivatives in "dh"
+  // (the recursion is on "fh"); returns the derivative of "h" with respect
+  // to its previous value
+  double increment_vol_grad(volatility& vol, double* dh, const double& yim1) {
+    double fhm1 = vol.fh;
+    increment_vol(vol, yim1);
+    double a = vol.fh * beta / fhm1;  // dh / dhm1
+    dh[0] = 2 * vol.fh + a * dh[0];
+    dh[1] = 2 * vol.fh * ((yim1 >= 0) ? yim1 : 0) + a * dh[1];
+    dh[2] = 2 * vol.fh * ((yim1 < 0) ? -yim1 : 0) + a * dh[2];
+    dh[3] = 2 * vol.fh * fhm1 + a * dh[3];
+    return a;
+  }
+
+  // no closed form for the expected variance (the recursion is on the
+  // volatility, see 'f_forecast_var')
+  bool forecast_coeffs(double* c) { return false; }
+
   // some nested-call functions
   void prep_kernel() { fz.prep_kernel(); }
   NumericVector rndgen(const int& n) { return fz.rndgen(n); }
+  template <typename Gen>
+  double draw(Gen& gen, const int& method) {
+    return fz.draw(gen, method);
+  }
+  double invsample(const double& u) { return fz.calc_invsample(u); }
+  void prep_rnd() { fz.prep_rnd(); }
+  double invsample_table(const double& u) {
+    return fz.calc_invsample_table(u);
+  }
+  void prep_table() { fz.prep_table(); }
   double calc_pdf(const double& x) { return fz.calc_pdf(x); }
   double calc_cdf(const double& x) { return fz.calc_cdf(x); }
   double calc_kernel(const volatility& vol, const double& yi) {
     return fz.calc_kernel(vol, yi);
   }
+  void calc_kernel_block(const double* h, const double* lnh, const double* y,
+                         double* out, const int& n) {
+    fz.calc_kernel_block(h, lnh, y, out, n);
+  }
+  double calc_kernel_dh(const volatility& vol, const double& yi) {
+    return fz.calc_kernel_dh(vol, yi);
+  }
 };
 
 #endif  // tGARCH.h